@@ -13,6 +13,7 @@
 #include "clang/ARCMigrate/FileRemapper.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Frontend/CompilerInvocation.h"
+#include <memory>
 
 namespace clang {
   class ASTContext;
@@ -72,6 +73,27 @@ bool migrateWithTemporaryFiles(
     DiagnosticConsumer *DiagClient, StringRef outputDir,
     bool emitPremigrationARCErrors, StringRef plistOut);
 
+/// \brief Applies automatic modifications to each of \p Inputs, migrating up
+/// to \p NumThreads translation units at a time (all available hardware
+/// threads if zero).
+///
+/// Every input is migrated independently against the same starting state of
+/// the files, so the changes two inputs make to a header they share are
+/// merged line by line; changes to the same lines which differ are reported
+/// as conflicts. The merged result is written as temporary files and metadata
+/// into \p outputDir like migrateWithTemporaryFiles does, or over the
+/// original files if \p outputDir is empty.
+///
+/// Diagnostics of each input are written to \p DiagOS once all inputs are
+/// migrated, in the order of \p Inputs.
+///
+/// \returns false if no error is produced, true otherwise.
+bool migrateInParallel(CompilerInvocation &origCI,
+                       ArrayRef<FrontendInputFile> Inputs,
+                       std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                       raw_ostream &DiagOS, StringRef outputDir,
+                       unsigned NumThreads = 0);
+
 /// \brief Get the set of file remappings from the \p outputDir path that
 /// migrateWithTemporaryFiles produced.
 ///
@@ -100,6 +122,14 @@ class MigrationProcess {
   DiagnosticConsumer *DiagClient;
   FileRemapper Remapper;
 
+  struct ParsedUnit;
+  /// \brief The unit the last transform ran on. It is kept only while it
+  /// still matches the remapped files, i.e. if that transform changed
+  /// nothing, so that the next transform need not parse again.
+  std::unique_ptr<ParsedUnit> LastUnit;
+
+  unsigned NumParses;
+
 public:
   bool HadARCErrors;
 
@@ -107,6 +137,7 @@ public:
                    std::shared_ptr<PCHContainerOperations> PCHContainerOps,
                    DiagnosticConsumer *diagClient,
                    StringRef outputDir = StringRef());
+  ~MigrationProcess();
 
   class RewriteListener {
   public:
@@ -121,7 +152,14 @@ public:
 
   bool applyTransform(TransformFn trans, RewriteListener *listener = nullptr);
 
+  /// \brief Returns the remapped files. Changing them invalidates the unit
+  /// kept for the next transform, so call discardParsedUnit() after doing so.
   FileRemapper &getRemapper() { return Remapper; }
+
+  void discardParsedUnit();
+
+  /// \brief The number of times the source files were parsed.
+  unsigned getNumParses() const { return NumParses; }
 };
 
 } // end namespace arcmt
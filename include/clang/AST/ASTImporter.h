@@ -15,6 +15,7 @@
 #define LLVM_CLANG_AST_ASTIMPORTER_H
 
 #include "clang/AST/DeclarationName.h"
+#include "clang/AST/ExternalASTSource.h"
 #include "clang/AST/Type.h"
 #include "clang/Basic/SourceLocation.h"
 #include "llvm/ADT/DenseMap.h"
@@ -39,6 +40,7 @@ namespace clang {
   class ASTImporter {
   public:
     typedef llvm::DenseSet<std::pair<Decl *, Decl *> > NonEquivalentDeclSet;
+    typedef llvm::DenseSet<std::pair<Decl *, Decl *> > EquivalentDeclSet;
     
   private:
     /// \brief The contexts we're importing to and from.
@@ -50,6 +52,10 @@ namespace clang {
     /// \brief Whether to perform a minimal import.
     bool Minimal;
 
+    /// \brief Whether to import the members of namespaces and classes only
+    /// when they are looked up, see \c setLazyMemberImport().
+    bool LazyMembers;
+
     /// \brief Whether the last diagnostic came from the "from" context.
     bool LastDiagFromFrom;
     
@@ -76,6 +82,15 @@ namespace clang {
     /// \brief Declaration (from, to) pairs that are known not to be equivalent
     /// (which we have already complained about).
     NonEquivalentDeclSet NonEquivalentDecls;
+
+    /// \brief Canonical declaration (from, to) pairs that were proven to be
+    /// structurally equivalent, so that later imports don't check them again.
+    EquivalentDeclSet EquivalentDecls;
+
+    /// \brief Mapping from the (primary) declaration contexts in the "to"
+    /// context whose members are imported lazily to the corresponding
+    /// contexts in the "from" context.
+    llvm::DenseMap<const DeclContext *, DeclContext *> LazyContexts;
     
   public:
     /// \brief Create a new AST importer.
@@ -100,6 +115,35 @@ namespace clang {
     /// \brief Whether the importer will perform a minimal import, creating
     /// to-be-completed forward declarations when possible.
     bool isMinimalImport() const { return Minimal; }
+
+    /// \brief Whether the importer will import the members of namespaces and
+    /// classes only when they are looked up.
+    bool isLazyMemberImport() const { return LazyMembers; }
+
+    /// \brief Import the members of namespaces and classes only when they
+    /// are looked up in the "to" context.
+    ///
+    /// The fields, bases and unnamed members of a class are still imported
+    /// with its definition, as are all members of dynamic classes. Iterating
+    /// over the members of a lazily imported context only visits the members
+    /// imported so far; use \c ImportDefinition() to import all of them.
+    ///
+    /// This is turned on by adding the importer to the
+    /// \c ASTImporterLookupSource which is the external AST source of the
+    /// "to" context; without an external source, members are imported
+    /// eagerly.
+    void setLazyMemberImport(bool Lazy) { LazyMembers = Lazy; }
+
+    /// \brief Note that the members of \p FromDC will be imported into
+    /// \p ToDC when they are looked up.
+    void setLazyContext(DeclContext *ToDC, DeclContext *FromDC);
+
+    /// \brief Return the context in the "from" context whose members are
+    /// imported into \p ToDC on lookup, or NULL if \p ToDC is not such a
+    /// context.
+    DeclContext *getLazyContextOrigin(const DeclContext *ToDC) const {
+      return LazyContexts.lookup(ToDC);
+    }
     
     /// \brief Import the given type from the "from" context into the "to"
     /// context.
@@ -273,6 +317,9 @@ namespace clang {
     /// \brief Return the set of declarations that we know are not equivalent.
     NonEquivalentDeclSet &getNonEquivalentDecls() { return NonEquivalentDecls; }
 
+    /// \brief Return the set of declarations that we know are equivalent.
+    EquivalentDeclSet &getEquivalentDecls() { return EquivalentDecls; }
+
     /// \brief Called for ObjCInterfaceDecl, ObjCProtocolDecl, and TagDecl.
     /// Mark the Decl as complete, filling it in as much as possible.
     ///
@@ -299,6 +346,48 @@ namespace clang {
     bool IsStructurallyEquivalent(QualType From, QualType To,
                                   bool Complain = true);
   };
+
+  /// \brief An external AST source which imports the members of namespaces
+  /// and classes when they are looked up, for a set of \c ASTImporters
+  /// importing into the same context.
+  ///
+  /// Install it as the external AST source of the "to" context and add each
+  /// importer to it. The importers have to outlive any lookup into the "to"
+  /// context.
+  class ASTImporterLookupSource : public ExternalASTSource {
+    /// \brief The importers whose lazily imported contexts we complete.
+    SmallVector<ASTImporter *, 4> Importers;
+
+    /// \brief The lookups that are importing declarations right now. A
+    /// lookup of the same name in the same context while importing them
+    /// finds nothing new.
+    SmallVector<std::pair<const DeclContext *, DeclarationName>, 4>
+      ActiveLookups;
+
+    /// \brief The number of lookups which imported declarations.
+    unsigned NumLookups;
+
+    /// \brief The number of declarations imported on lookup.
+    unsigned NumDeclsImported;
+
+  public:
+    ASTImporterLookupSource() : NumLookups(0), NumDeclsImported(0) {}
+
+    /// \brief Import the members of the contexts \p Importer imports when
+    /// they are looked up.
+    void addImporter(ASTImporter &Importer) {
+      Importer.setLazyMemberImport(true);
+      Importers.push_back(&Importer);
+    }
+
+    bool FindExternalVisibleDeclsByName(const DeclContext *DC,
+                                        DeclarationName Name) override;
+    void completeVisibleDeclsMap(const DeclContext *DC) override;
+    void PrintStats() override;
+
+    unsigned getNumLookups() const { return NumLookups; }
+    unsigned getNumDeclsImported() const { return NumDeclsImported; }
+  };
 }
 
 #endif // LLVM_CLANG_AST_ASTIMPORTER_H
@@ -22,6 +22,7 @@
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SmallVector.h"
 #include <algorithm>
+#include <memory>
 
 namespace clang {
 
@@ -236,13 +237,77 @@ public:
   }
 };
 
-class StoredDeclsMap
-  : public llvm::SmallDenseMap<DeclarationName, StoredDeclsList, 4> {
+/// \brief The lookup table of a DeclContext, mapping each name to the
+/// declarations with that name.
+///
+/// Most contexts declare only a handful of names, so the entries are kept in
+/// insertion order in a vector which is searched linearly. Once the table
+/// grows past MaxLinearEntries names, a hash index into the vector is built.
+class StoredDeclsMap {
+public:
+  typedef std::pair<DeclarationName, StoredDeclsList> value_type;
+
+private:
+  enum { NumInlineEntries = 4, MaxLinearEntries = 8 };
+
+  typedef SmallVector<value_type, NumInlineEntries> EntriesTy;
+  EntriesTy Entries;
+
+  /// \brief The position of each name in Entries, once there are too many of
+  /// them to search linearly.
+  std::unique_ptr<llvm::DenseMap<DeclarationName, unsigned>> Index;
 
 public:
+  typedef EntriesTy::iterator iterator;
+  typedef EntriesTy::const_iterator const_iterator;
+
+  iterator begin() { return Entries.begin(); }
+  iterator end() { return Entries.end(); }
+  const_iterator begin() const { return Entries.begin(); }
+  const_iterator end() const { return Entries.end(); }
+
+  unsigned size() const { return Entries.size(); }
+  bool empty() const { return Entries.empty(); }
+
+  /// \brief Whether lookups use the hash index rather than a linear scan.
+  bool isIndexed() const { return Index != nullptr; }
+
+  iterator find(DeclarationName Name) {
+    if (Index) {
+      auto Pos = Index->find(Name);
+      return Pos == Index->end() ? end() : begin() + Pos->second;
+    }
+    for (iterator I = begin(), E = end(); I != E; ++I)
+      if (I->first == Name)
+        return I;
+    return end();
+  }
+
+  std::pair<iterator, bool> insert(value_type &&Entry) {
+    iterator I = find(Entry.first);
+    if (I != end())
+      return std::make_pair(I, false);
+    Entries.push_back(std::move(Entry));
+    if (Index)
+      Index->insert(std::make_pair(Entries.back().first, size() - 1));
+    else if (size() > MaxLinearEntries)
+      buildIndex();
+    return std::make_pair(end() - 1, true);
+  }
+
+  StoredDeclsList &operator[](DeclarationName Name) {
+    return insert(value_type(Name, StoredDeclsList())).first->second;
+  }
+
+  /// \brief The approximate number of bytes allocated for the table itself,
+  /// not including the declaration lists.
+  size_t getMemorySize() const;
+
   static void DestroyAll(StoredDeclsMap *Map, bool Dependent);
 
 private:
+  void buildIndex();
+
   friend class ASTContext; // walks the chain deleting these
   friend class DeclContext;
   llvm::PointerIntPair<StoredDeclsMap*, 1> Previous;
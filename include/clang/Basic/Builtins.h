@@ -17,7 +17,9 @@
 #define LLVM_CLANG_BASIC_BUILTINS_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include <cstring>
+#include <vector>
 
 // VC++ defines 'alloca' as an object-like macro, which interferes with our
 // builtins.
@@ -66,8 +68,21 @@ class Context {
   llvm::ArrayRef<Info> TSRecords;
   llvm::ArrayRef<Info> AuxTSRecords;
 
+  /// \brief The language options used to filter target builtins which are
+  /// marked lazily, or null if target builtins are registered up front.
+  const LangOptions *LazyLangOpts;
+
+  /// \brief Open-addressed hash table over the names of the target builtins.
+  ///
+  /// Each slot holds an index into TSRecords followed by AuxTSRecords, plus
+  /// one; zero marks an empty slot. Built on the first lazy lookup.
+  std::vector<unsigned> LazyIndex;
+
+  unsigned NumLazyLookups;
+  unsigned NumLazyBuiltins;
+
 public:
-  Context() {}
+  Context() : LazyLangOpts(nullptr), NumLazyLookups(0), NumLazyBuiltins(0) {}
 
   /// \brief Perform target-specific initialization
   /// \param AuxTarget Target info to incorporate builtins from. May be nullptr.
@@ -78,6 +93,19 @@ public:
   /// such.
   void initializeBuiltins(IdentifierTable &Table, const LangOptions& LangOpts);
 
+  /// \brief Mark the identifiers of target-specific builtins when \p Table
+  /// first creates them, instead of entering thousands of them up front in
+  /// initializeBuiltins.
+  void enableLazyTargetBuiltins(IdentifierTable &Table,
+                                const LangOptions &LangOpts);
+
+  /// \brief Return the ID of the supported target-specific builtin called
+  /// \p Name, or 0 if there is none.
+  unsigned lookupTargetBuiltin(llvm::StringRef Name);
+
+  /// \brief Print statistics about lazily registered builtins to stderr.
+  void PrintStats() const;
+
   /// \brief Return the identifier name for the specified builtin,
   /// e.g. "__builtin_abs".
   const char *getName(unsigned ID) const {
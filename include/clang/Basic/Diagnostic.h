@@ -22,6 +22,9 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/iterator_range.h"
 #include <list>
 #include <vector>
@@ -176,6 +179,7 @@ private:
   bool FatalsAsError;             // Treat fatal errors like errors.
   bool SuppressSystemWarnings;   // Suppress warnings in system headers.
   bool SuppressAllDiagnostics;   // Suppress all diagnostics.
+  bool SuppressDuplicates;       // Suppress repeated diagnostics.
   bool ElideType;                // Elide common types of templates.
   bool PrintTemplateTree;        // Print a tree when comparing templates.
   bool ShowColors;               // Color printing is enabled.
@@ -305,6 +309,36 @@ private:
   unsigned NumWarnings;         ///< Number of warnings reported
   unsigned NumErrors;           ///< Number of errors reported
 
+public:
+  /// \brief The number of warnings and errors of one diagnostic group that
+  /// were reported, and of those that were suppressed as duplicates.
+  struct GroupCount {
+    unsigned Reported;
+    unsigned Duplicates;
+
+    GroupCount() : Reported(0), Duplicates(0) {}
+  };
+
+private:
+  /// \brief The counts of warnings and errors per warning option, without
+  /// the -W prefix. Diagnostics which have no option are counted under "".
+  llvm::StringMap<GroupCount> GroupCounts;
+
+  /// \brief The identities (ID, location and arguments) of the warnings and
+  /// errors emitted so far, when duplicates are suppressed.
+  llvm::StringSet<> EmittedDiagnostics;
+
+  /// \brief The formatted message of the diagnostic in flight, shared by all
+  /// the consumers which ask for it.
+  mutable SmallString<128> FormattedCurDiag;
+  mutable bool HasFormattedCurDiag;
+
+  // Statistics for -print-stats.
+  bool CollectStats;
+  mutable unsigned NumFormattedMessages, NumReusedMessages;
+  unsigned NumDroppedNotes;
+  mutable double FormattingTime; ///< Process time, in seconds.
+
   /// \brief A function pointer that converts an opaque diagnostic
   /// argument to a strings.
   ///
@@ -473,6 +507,30 @@ public:
   }
   bool getSuppressAllDiagnostics() const { return SuppressAllDiagnostics; }
 
+  /// \brief When set to true, a warning or error that was already emitted
+  /// with the same location and arguments is not emitted again, and
+  /// neither are its notes.
+  ///
+  /// Suppressed errors still mark the compilation as failed, but don't count
+  /// towards the error limit.
+  void setSuppressDuplicateDiagnostics(bool Val = true) {
+    SuppressDuplicates = Val;
+  }
+  bool getSuppressDuplicateDiagnostics() const { return SuppressDuplicates; }
+
+  /// \brief Measure the time spent formatting diagnostic messages, for
+  /// PrintStats().
+  void setCollectStats(bool Val = true) { CollectStats = Val; }
+
+  /// \brief Print statistics about formatting diagnostics to stderr.
+  void PrintStats() const;
+
+  /// \brief Return the number of warnings and errors reported so far for
+  /// each warning option.
+  const llvm::StringMap<GroupCount> &getGroupCounts() const {
+    return GroupCounts;
+  }
+
   /// \brief Set type eliding, to skip outputting same types occurring in
   /// template types.
   void setElideType(bool Val = true) { ElideType = Val; }
@@ -1126,6 +1184,7 @@ inline DiagnosticBuilder DiagnosticsEngine::Report(SourceLocation Loc,
   CurDiagLoc = Loc;
   CurDiagID = DiagID;
   FlagValue.clear();
+  HasFormattedCurDiag = false;
   return DiagnosticBuilder(this);
 }
 
@@ -1356,6 +1415,15 @@ public:
   /// The default implementation returns true.
   virtual bool IncludeInDiagnosticCounts() const;
 
+  /// \brief Indicates whether this DiagnosticConsumer looks at notes.
+  ///
+  /// Consumers which only count warnings and errors, or filter them by ID or
+  /// location, return false. When no consumer needs notes, they are dropped
+  /// before being handled, and clients may skip producing them.
+  ///
+  /// The default implementation returns true.
+  virtual bool needsNotes() const { return true; }
+
   /// \brief Handle this diagnostic, reporting it to the user or
   /// capturing it to a log as needed.
   ///
@@ -1368,6 +1436,7 @@ public:
 /// \brief A diagnostic client that ignores all diagnostics.
 class IgnoringDiagConsumer : public DiagnosticConsumer {
   virtual void anchor();
+  bool needsNotes() const override { return false; }
   void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
                         const Diagnostic &Info) override {
     // Just ignore it.
@@ -1390,6 +1459,7 @@ public:
   void clear() override;
 
   bool IncludeInDiagnosticCounts() const override;
+  bool needsNotes() const override;
 };
 
 // Struct used for sending info about how a type should be printed.
@@ -88,6 +88,12 @@ public:
   /// \brief The file to serialize diagnostics to (non-appending).
   std::string DiagnosticSerializationFile;
 
+  /// \brief The file to append diagnostics to as JSON Lines.
+  std::string DiagnosticJSONFile;
+
+  /// \brief The file to write diagnostics to as a SARIF log (non-appending).
+  std::string DiagnosticSARIFFile;
+
   /// The list of -W... options used to alter the diagnostic mappings, with the
   /// prefixes removed.
   std::vector<std::string> Warnings;
@@ -254,6 +254,16 @@ public:
   /// \brief Remove the real file \p Entry from the cache.
   void invalidateCache(const FileEntry *Entry);
 
+  /// \brief Check whether the cached file and directory lookups, including
+  /// cached failures, still agree with the file system.
+  ///
+  /// Every cached real file is re-stat'ed and compared by identity, size and
+  /// modification time. This lets a long-lived process decide whether this
+  /// FileManager can be reused for another compilation.
+  ///
+  /// \returns false if anything changed, or if virtual files were created.
+  bool isCacheUpToDate();
+
   /// \brief If path is not absolute and FileSystemOptions set the working
   /// directory, the path is modified to be relative to the given
   /// working directory.
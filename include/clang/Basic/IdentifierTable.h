@@ -28,6 +28,9 @@ namespace llvm {
 }
 
 namespace clang {
+  namespace Builtin {
+    class Context;
+  }
   class LangOptions;
   class IdentifierInfo;
   class IdentifierTable;
@@ -451,6 +454,13 @@ class IdentifierTable {
 
   IdentifierInfoLookup* ExternalLookup;
 
+  /// \brief If set, the builtins whose identifiers are marked when they are
+  /// first created rather than up front.
+  Builtin::Context *LazyBuiltins;
+
+  /// \brief Mark \p II as a builtin if LazyBuiltins has one by its name.
+  void markLazyBuiltin(IdentifierInfo &II);
+
 public:
   /// \brief Create the identifier table, populating it with info about the
   /// language keywords for the language specified by \p LangOpts.
@@ -466,6 +476,14 @@ public:
   IdentifierInfoLookup *getExternalIdentifierLookup() const {
     return ExternalLookup;
   }
+
+  /// \brief Set the builtins to mark lazily as their identifiers are created.
+  ///
+  /// Identifiers which already exist are checked immediately.
+  void setLazyBuiltins(Builtin::Context *Builtins);
+
+  /// \brief Retrieve the lazily registered builtins, if any.
+  Builtin::Context *getLazyBuiltins() const { return LazyBuiltins; }
   
   llvm::BumpPtrAllocator& getAllocator() {
     return HashTable.getAllocator();
@@ -494,6 +512,10 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    // All target-specific builtin names start with an underscore.
+    if (LazyBuiltins && Name.startswith("_"))
+      markLazyBuiltin(*II);
+
     return *II;
   }
 
@@ -525,6 +547,10 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    // All target-specific builtin names start with an underscore.
+    if (LazyBuiltins && Name.startswith("_"))
+      markLazyBuiltin(*II);
+
     // If this is the 'import' contextual keyword, mark it as such.
     if (Name.equals("import"))
       II->setModulesImport(true);
@@ -631,6 +631,14 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// Same indexing as LoadedSLocEntryTable.
   llvm::BitVector SLocEntryLoaded;
 
+  /// \brief The starting offset of each loaded SLocEntry, or 0 if it is not
+  /// known yet.
+  ///
+  /// This is always resident, and is filled in by the external source when
+  /// it knows the offsets up front, so that searching the loaded entries does
+  /// not require deserializing them. Same indexing as LoadedSLocEntryTable.
+  mutable SmallVector<unsigned, 0> LoadedSLocEntryOffsets;
+
   /// \brief An external source for source location entries.
   ExternalSLocEntrySource *ExternalSLocEntries;
 
@@ -640,6 +648,13 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// is very common to look up many tokens from the same file.
   mutable FileID LastFileIDLookup;
 
+  /// \brief The files that were most recently in LastFileIDLookup, checked
+  /// after it misses when jumping between many files, e.g. between the
+  /// headers of many modules.
+  enum { FileIDLookasideSize = 8 };
+  mutable FileID FileIDLookaside[FileIDLookasideSize];
+  mutable unsigned NextFileIDLookaside;
+
   /// \brief Holds information for \#line directives.
   ///
   /// This is referenced by indices from SLocEntryTable.
@@ -659,14 +674,37 @@ class SourceManager : public RefCountedBase<SourceManager> {
   FileID PreambleFileID;
 
   // Statistics for -print-stats.
-  mutable unsigned NumLinearScans, NumBinaryProbes;
+  mutable unsigned NumLinearScans, NumBinaryProbes, NumLookasideHits;
+  unsigned NumPrecomputedLineTables;
+  unsigned NumExpansionEntries, NumMergedMacroArgExpansions;
+  unsigned ExpansionAddrSpaceUsed;
+
+  /// \brief The position of a FileID in the tree of \#includes and macro
+  /// expansions.
+  struct IncludeTreeNode {
+    /// \brief The "included/expanded in" decomposed location, or an invalid
+    /// FileID for the root of the tree.
+    std::pair<FileID, unsigned> Parent;
+
+    /// \brief The number of FileIDs on the path from the root to this one,
+    /// including both, or zero if the node was not computed yet.
+    unsigned Depth;
+
+    IncludeTreeNode() : Depth(0) {}
+  };
 
-  /// \brief Associates a FileID with its "included/expanded in" decomposed
-  /// location.
+  /// \brief The lazily computed include tree nodes of the local and loaded
+  /// FileIDs, indexed like LocalSLocEntryTable and LoadedSLocEntryTable.
   ///
-  /// Used to cache results from and speed-up \c getDecomposedIncludedLoc
-  /// function.
-  mutable llvm::DenseMap<FileID, std::pair<FileID, unsigned> > IncludedLocMap;
+  /// Used by \c getDecomposedIncludedLoc and to find the nearest common
+  /// ancestor of two locations in \c isBeforeInTranslationUnit without
+  /// building include chains.
+  mutable std::vector<IncludeTreeNode> LocalIncludeTree;
+  mutable std::vector<IncludeTreeNode> LoadedIncludeTree;
+
+  /// \brief Return the include tree node of \p FID, computing it and the
+  /// nodes of its ancestors if needed.
+  IncludeTreeNode getIncludeTreeNode(FileID FID) const;
 
   /// The key value into the IsBeforeInTUCache table.
   typedef std::pair<FileID, FileID> IsBeforeInTUCacheKey;
@@ -809,6 +847,15 @@ public:
   /// fact that a token from SpellingLoc should actually be referenced from
   /// ExpansionLoc, and that it represents the expansion of a macro argument
   /// into the function-like macro body.
+  ///
+  /// Consecutive tokens of a macro argument share a single SLocEntry: if the
+  /// previous entry expands to the same \p ExpansionLoc and its spelling ends
+  /// shortly before \p Loc, it is extended to cover the new token instead of
+  /// creating another entry. For example, for
+  /// \code
+  ///   assert(foo == bar);
+  /// \endcode
+  /// there is a single SLocEntry for the "foo == bar" chunk.
   SourceLocation createMacroArgExpansionLoc(SourceLocation Loc,
                                             SourceLocation ExpansionLoc,
                                             unsigned TokLength);
@@ -1286,6 +1333,15 @@ public:
   unsigned getExpansionLineNumber(SourceLocation Loc, bool *Invalid = nullptr) const;
   unsigned getPresumedLineNumber(SourceLocation Loc, bool *Invalid = nullptr) const;
 
+  /// \brief Return the offsets of the lines of the file \p FID, computing
+  /// them if needed, or an empty array if the file cannot be read.
+  ArrayRef<unsigned> getLineOffsets(FileID FID) const;
+
+  /// \brief Provide the offsets of the lines of the file \p FID, e.g. as
+  /// computed when it was written to an AST file, so that they don't have to
+  /// be computed by scanning the file. Ignored if they are already known.
+  void setPrecomputedLineOffsets(FileID FID, ArrayRef<unsigned> LineOffsets);
+
   /// \brief Return the filename or buffer identifier of the buffer the
   /// location is in.
   ///
@@ -1499,6 +1555,10 @@ public:
   ///
   void PrintStats() const;
 
+  /// \brief Get the number of slow FileID lookups answered by the lookaside
+  /// cache of recently used files.
+  unsigned getNumFileIDLookasideHits() const { return NumLookasideHits; }
+
   void dump() const;
 
   /// \brief Get the number of local SLocEntries we have.
@@ -1523,6 +1583,24 @@ public:
     return loadSLocEntry(Index, Invalid);
   }
 
+  /// \brief Get the starting offset of a loaded SLocEntry, only loading the
+  /// entry if the external source did not provide the offset.
+  unsigned getLoadedSLocEntryOffset(unsigned Index) const {
+    assert(Index < LoadedSLocEntryOffsets.size() && "Invalid index");
+    if (unsigned Offset = LoadedSLocEntryOffsets[Index])
+      return Offset;
+    return getLoadedSLocEntry(Index).getOffset();
+  }
+
+  /// \brief Record the starting offset of the loaded SLocEntry \p ID before
+  /// it is loaded.
+  void setLoadedSLocEntryOffset(int ID, unsigned Offset) {
+    unsigned Index = unsigned(-ID) - 2;
+    assert(Index < LoadedSLocEntryOffsets.size() && "FileID out of range");
+    assert(Offset >= CurrentLoadedOffset && "Offset is not loaded");
+    LoadedSLocEntryOffsets[Index] = Offset;
+  }
+
   const SrcMgr::SLocEntry &getSLocEntry(FileID FID,
                                         bool *Invalid = nullptr) const {
     if (FID.ID == 0 || FID.ID == -1) {
@@ -1613,9 +1691,24 @@ private:
                                         int LoadedID = 0,
                                         unsigned LoadedOffset = 0);
 
+  /// Try to extend the last local SLocEntry, a macro argument expansion, to
+  /// also cover \p Expansion. Returns an invalid location on failure.
+  SourceLocation
+  extendMacroArgExpansionLoc(const SrcMgr::ExpansionInfo &Expansion,
+                             unsigned TokLength);
+
   /// \brief Return true if the specified FileID contains the
   /// specified SourceLocation offset.  This is a very hot method.
   inline bool isOffsetInFileID(FileID FID, unsigned SLocOffset) const {
+    // Loaded entries are checked against the offset index, so that they
+    // don't have to be deserialized.
+    if (FID.ID < -1) {
+      unsigned Index = unsigned(-FID.ID) - 2;
+      if (SLocOffset < getLoadedSLocEntryOffset(Index))
+        return false;
+      return Index == 0 || SLocOffset < getLoadedSLocEntryOffset(Index - 1);
+    }
+
     const SrcMgr::SLocEntry &Entry = getSLocEntry(FID);
     // If the entry is after the offset, it can't contain it.
     if (SLocOffset < Entry.getOffset()) return false;
@@ -180,6 +180,27 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// Signature of the entry point used to run a -cc1 invocation in the driver
+  /// process. The argument vector has the same layout as a separately
+  /// executed -cc1 job, i.e. the executable path followed by "-cc1".
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+
+  /// If set, -fintegrated-cc1 jobs are run in-process through this callback
+  /// instead of spawning a new process. Only tools which link the -cc1
+  /// frontend (e.g. the clang driver itself) provide it.
+  CC1ToolFunc CC1Main;
+
+  /// Signature of the entry point used to send a -cc1 invocation to a compile
+  /// server, with the same argument vector as CC1ToolFunc. Returns false if
+  /// the server could not be reached; \p Result is the job's exit status
+  /// otherwise.
+  typedef bool (*CC1ServerFunc)(ArrayRef<const char *> Argv, int &Result);
+
+  /// If set (CLANG_CC1_SERVER mode), -cc1 jobs are first sent to a compile
+  /// server through this callback. Jobs the server can't take are run as
+  /// usual.
+  CC1ServerFunc CC1Server;
+
 private:
   /// Default target triple.
   std::string DefaultTargetTriple;
@@ -65,6 +65,10 @@ class Command {
   /// proper response file
   llvm::opt::ArgStringList InputFileList;
 
+  /// Whether the command should be run in the driver process rather than by
+  /// spawning a new one. Only honored by commands which support it.
+  bool InProcess;
+
   /// String storage if we need to create a new argument to specify a response
   /// file
   std::string ResponseFileFlag;
@@ -111,6 +115,10 @@ public:
     InputFileList = std::move(List);
   }
 
+  /// Request (or stop requesting) in-process execution of this command.
+  void setInProcess(bool Value) { InProcess = Value; }
+  bool isInProcess() const { return InProcess; }
+
   const char *getExecutable() const { return Executable; }
 
   const llvm::opt::ArgStringList &getArguments() const { return Arguments; }
@@ -119,6 +127,23 @@ public:
   static void printArg(llvm::raw_ostream &OS, const char *Arg, bool Quote);
 };
 
+/// Like Command, but for a -cc1 job which may be run inside the driver
+/// process through Driver::CC1Main, avoiding the cost of starting a new
+/// process. Crashes in the in-process frontend are caught and reported the
+/// same way as a crashing child process.
+class CC1Command : public Command {
+public:
+  CC1Command(const Action &Source_, const Tool &Creator_,
+             const char *Executable_, const ArgStringList &Arguments_,
+             ArrayRef<InputInfo> Inputs);
+
+  void Print(llvm::raw_ostream &OS, const char *Terminator, bool Quote,
+             CrashReportInfo *CrashInfo = nullptr) const override;
+
+  int Execute(const StringRef **Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+};
+
 /// Like Command, but with a fallback which is executed in case
 /// the primary command crashes.
 class FallbackCommand : public Command {
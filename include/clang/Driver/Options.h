@@ -45,6 +45,10 @@ enum ID {
 }
 
 llvm::opt::OptTable *createDriverOptTable();
+
+/// Returns a driver option table which is built on first use and shared by
+/// the whole process.
+const llvm::opt::OptTable &getDriverOptTable();
 }
 }
 
@@ -57,6 +57,10 @@ public:
     return Primary->IncludeInDiagnosticCounts();
   }
 
+  bool needsNotes() const override {
+    return Primary->needsNotes() || Secondary->needsNotes();
+  }
+
   void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
                         const Diagnostic &Info) override {
     // Default implementation (Warnings/errors count).
@@ -125,6 +125,9 @@ class CompilerInstance : public ModuleLoader {
 
   std::vector<std::shared_ptr<DependencyCollector>> DependencyCollectors;
 
+  /// \brief The header cost collector, for -fheader-cost-report.
+  std::shared_ptr<HeaderCostCollector> HeaderCosts;
+
   /// \brief The set of top-level modules that has already been loaded,
   /// along with the module map
   llvm::DenseMap<const IdentifierInfo *, Module *> KnownModules;
@@ -504,6 +507,12 @@ public:
   void setModuleDepCollector(
       std::shared_ptr<ModuleDependencyCollector> Collector);
 
+  /// \brief Return the header cost collector, if -fheader-cost-report is
+  /// in effect.
+  HeaderCostCollector *getHeaderCostCollector() const {
+    return HeaderCosts.get();
+  }
+
   std::shared_ptr<PCHContainerOperations> getPCHContainerOperations() const {
     return ThePCHContainerOperations;
   }
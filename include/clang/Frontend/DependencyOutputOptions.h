@@ -56,6 +56,10 @@ public:
   /// \brief The file to write GraphViz-formatted header dependencies to.
   std::string DOTOutputFile;
 
+  /// \brief The file to write the header cost report to. If the output file
+  /// is "-", the report is sent to stderr.
+  std::string HeaderCostReportFile;
+
   /// \brief The directory to copy module dependencies to when collecting them.
   std::string ModuleDependencyOutputDir;
 
@@ -132,6 +132,8 @@ public:
                                            /// metrics and statistics.
   unsigned ShowTimers : 1;                 ///< Show timers for individual
                                            /// actions.
+  unsigned ShowStartupStats : 1;           ///< Show the time spent setting up
+                                           /// the compiler.
   unsigned ShowVersion : 1;                ///< Show the -version text.
   unsigned FixWhatYouCan : 1;              ///< Apply fixes even if there are
                                            /// unfixable errors.
@@ -273,10 +275,16 @@ public:
   // included by this file.
   std::string FindPchSource;
 
+  /// \brief If non-empty, the directory sharing chunks of preprocessed
+  /// output: -E stores large chunks there and refers to them by hash, and
+  /// preprocessed inputs have such references expanded from it.
+  std::string PreprocessedChunkDir;
+
 public:
   FrontendOptions() :
     DisableFree(false), RelocatablePCH(false), ShowHelp(false),
-    ShowStats(false), ShowTimers(false), ShowVersion(false),
+    ShowStats(false), ShowTimers(false), ShowStartupStats(false),
+    ShowVersion(false),
     FixWhatYouCan(false), FixOnlyWarnings(false), FixAndRecompile(false),
     FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
     SkipFunctionBodies(false), UseGlobalModuleIndex(true),
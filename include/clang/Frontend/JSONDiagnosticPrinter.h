@@ -0,0 +1,81 @@
+//===--- JSONDiagnosticPrinter.h - JSON/SARIF Diagnostic Client -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_JSONDIAGNOSTICPRINTER_H
+#define LLVM_CLANG_FRONTEND_JSONDIAGNOSTICPRINTER_H
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/StringRef.h"
+#include <memory>
+#include <string>
+
+namespace clang {
+class DiagnosticOptions;
+class LangOptions;
+class SourceManager;
+
+/// \brief A diagnostic client which writes each diagnostic as soon as it is
+/// reported, as structured JSON.
+///
+/// Every diagnostic, including notes, becomes one record with its level,
+/// message, warning option, category, location, ranges, fix-its and include
+/// stack. Locations are expanded out of macros and columns are 1-based;
+/// range and fix-it ends point just past the last character.
+///
+/// Two formats are supported:
+///
+/// - \c JSON writes one object per line (JSON Lines). Every record carries
+///   the main file name and is written with a single write, so parallel
+///   compiles can append to the same file and the result is still a valid
+///   stream of records.
+///
+/// - \c SARIF writes a SARIF 2.1.0 log with a single run, whose results are
+///   streamed out as they are reported. The log is closed by \c finish().
+class JSONDiagnosticPrinter : public DiagnosticConsumer {
+public:
+  enum OutputFormat { JSON, SARIF };
+
+private:
+  raw_ostream &OS;
+  std::unique_ptr<raw_ostream> StreamOwner;
+  OutputFormat Format;
+  const LangOptions *LangOpts;
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts;
+
+  std::string MainFilename;
+
+  /// \brief Whether the SARIF header was written, and whether the log was
+  /// closed.
+  bool StartedLog, FinishedLog;
+
+  /// \brief The number of diagnostics written so far.
+  unsigned NumRecords;
+
+  void startLog(raw_ostream &Out);
+
+public:
+  JSONDiagnosticPrinter(raw_ostream &OS, DiagnosticOptions *Diags,
+                        OutputFormat Format,
+                        std::unique_ptr<raw_ostream> StreamOwner);
+  ~JSONDiagnosticPrinter() override;
+
+  void BeginSourceFile(const LangOptions &LO, const Preprocessor *PP) override {
+    LangOpts = &LO;
+  }
+
+  void finish() override;
+
+  void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
+                        const Diagnostic &Info) override;
+};
+
+} // end namespace clang
+
+#endif
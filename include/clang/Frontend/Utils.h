@@ -17,12 +17,16 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/VirtualFileSystem.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Option/OptSpecifier.h"
+#include <map>
+#include <memory>
 #include <utility>
 
 namespace llvm {
+class MemoryBuffer;
 class raw_fd_ostream;
 class Triple;
 
@@ -33,14 +37,17 @@ class ArgList;
 
 namespace clang {
 class ASTConsumer;
+class ASTContext;
 class ASTReader;
 class CompilerInstance;
 class CompilerInvocation;
 class Decl;
+class DeclContext;
 class DependencyOutputOptions;
 class DiagnosticsEngine;
 class DiagnosticOptions;
 class ExternalSemaSource;
+class FileEntry;
 class FileManager;
 class HeaderSearch;
 class HeaderSearchOptions;
@@ -71,6 +78,21 @@ void InitializePreprocessor(Preprocessor &PP, const PreprocessorOptions &PPOpts,
 void DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream* OS,
                               const PreprocessorOutputOptions &Opts);
 
+/// Write the -E output \p Text to \p OS, storing each large chunk of text
+/// between line markers once in \p ChunkDir and referring to it by the hash
+/// of its contents. Returns false if a chunk could not be stored.
+bool WriteDeduplicatedPreprocessedOutput(StringRef Text, StringRef ChunkDir,
+                                         raw_ostream &OS,
+                                         DiagnosticsEngine &Diags);
+
+/// Replace the chunk references in \p Input, as written by
+/// WriteDeduplicatedPreprocessedOutput, with the chunks in \p ChunkDir.
+/// \p Expanded is left null if \p Input has no references. Returns false if
+/// a chunk is missing or damaged.
+bool ExpandPreprocessedChunks(const llvm::MemoryBuffer &Input,
+                              StringRef ChunkDir, DiagnosticsEngine &Diags,
+                              std::unique_ptr<llvm::MemoryBuffer> &Expanded);
+
 /// An interface for collecting the dependencies of a compilation. Users should
 /// use \c attachToPreprocessor and \c attachToASTReader to get all of the
 /// dependencies.
@@ -170,6 +192,47 @@ void AttachHeaderIncludeGen(Preprocessor &PP,
                             StringRef OutputPath = "",
                             bool ShowDepth = true, bool MSStyle = false);
 
+/// Collects what each header costs a compilation, for -fheader-cost-report:
+/// how often it is included, the bytes and tokens lexed from it, the time
+/// spent while it is the innermost file being read (which covers parsing the
+/// tokens read from it), and how many of its declarations are referenced.
+class HeaderCostCollector {
+public:
+  struct FileCost {
+    unsigned Includes = 0;  ///< Inclusions, including skipped ones.
+    unsigned Entries = 0;   ///< Inclusions which entered the file.
+    uint64_t Bytes = 0;     ///< Bytes of the file lexed over all entries.
+    uint64_t Tokens = 0;    ///< Tokens produced while in the file.
+    double Seconds = 0;     ///< Wall time spent while in the file.
+    unsigned Decls = 0;     ///< Declarations made by the file.
+    unsigned ReferencedDecls = 0; ///< Declarations which were referenced.
+  };
+
+private:
+  std::string OutputPath;
+  SourceManager *SM = nullptr;
+  /// The costs of each file. The include stack points into the map, so its
+  /// elements must not move.
+  std::map<const FileEntry *, FileCost> Costs;
+
+  /// The files currently being read; null for buffers without a file, such
+  /// as the predefines.
+  SmallVector<FileCost *, 16> IncludeStack;
+  double LastTime = 0;
+
+  friend class HeaderCostCallbacks;
+  void chargeTime();
+  void countDecls(const DeclContext *DC);
+
+public:
+  explicit HeaderCostCollector(StringRef OutputPath) : OutputPath(OutputPath) {}
+
+  void attachToPreprocessor(Preprocessor &PP);
+
+  /// Write the report. Declarations are counted in \p Ctx, if given.
+  void writeReport(ASTContext *Ctx, DiagnosticsEngine &Diags);
+};
+
 /// Cache tokens for use with PCH. Note that this requires a seekable stream.
 void CacheTokens(Preprocessor &PP, raw_pwrite_stream *OS);
 
@@ -84,6 +84,10 @@ class MacroInfo {
   /// \brief Whether this macro contains the sequence ", ## __VA_ARGS__"
   bool HasCommaPasting : 1;
 
+  /// \brief Whether the replacement list mentions any of the arguments.
+  mutable bool UsesArguments : 1;
+  mutable bool IsArgumentUseCached : 1;
+
   //===--------------------------------------------------------------------===//
   // State that changes as the macro is used.
 
@@ -168,6 +172,7 @@ public:
     NumArguments = List.size();
     ArgumentList = PPAllocator.Allocate<IdentifierInfo *>(List.size());
     std::copy(List.begin(), List.end(), ArgumentList);
+    IsArgumentUseCached = false;
   }
 
   /// Arguments - The list of arguments for a function-like macro.  This can be
@@ -247,6 +252,15 @@ public:
         !IsDefinitionLengthCached &&
         "Changing replacement tokens after definition length got calculated");
     ReplacementTokens.push_back(Tok);
+    IsArgumentUseCached = false;
+  }
+
+  /// \brief Return true if the replacement list refers to any of the
+  /// arguments, so that expanding the macro requires substituting them.
+  bool usesArguments() const {
+    if (IsArgumentUseCached)
+      return UsesArguments;
+    return usesArgumentsSlow();
   }
 
   /// \brief Return true if this macro is enabled.
@@ -286,6 +300,7 @@ public:
 
 private:
   unsigned getDefinitionLengthSlow(SourceManager &SM) const;
+  bool usesArgumentsSlow() const;
 
   void setOwningModuleID(unsigned ID) {
     assert(isFromASTFile());
@@ -0,0 +1,94 @@
+//===--- PredefinesCache.h - Cache of parsed predefined macros --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the PreparsedMacros and PredefinesCache classes, which let
+/// several compilations in one process share the result of parsing the
+/// compiler and target predefines.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_PREDEFINESCACHE_H
+#define LLVM_CLANG_LEX_PREDEFINESCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/TokenKinds.h"
+#include "llvm/ADT/StringRef.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clang {
+
+/// \brief The macro definitions made by the first part of a predefines
+/// buffer, recorded independently of the Preprocessor that parsed them.
+///
+/// The predefined part must start with the \c # \c 1 \c "<built-in>" \c 3 line
+/// marker and otherwise only contain \#define directives. All locations are
+/// recorded as offsets into the predefines buffer, so installing the macros
+/// into a Preprocessor whose predefines start with the same text produces the
+/// same macros, with the same source locations, as lexing that text.
+class PreparsedMacros {
+public:
+  /// \brief A token in the replacement list of a macro.
+  struct TokenInfo {
+    tok::TokenKind Kind;
+    unsigned short Flags;
+    unsigned Offset;
+    unsigned Length;
+    /// The spelling of the identifier, for identifiers and keywords.
+    std::string Identifier;
+  };
+
+  /// \brief A single \#define.
+  struct Definition {
+    std::string Name;
+    /// The offset of the macro name, which is where the macro is defined.
+    unsigned DefinitionOffset;
+    unsigned DefinitionEndOffset;
+    bool IsFunctionLike;
+    bool IsC99Varargs;
+    bool IsGNUVarargs;
+    bool HasCommaPasting;
+    std::vector<std::string> Arguments;
+    std::vector<TokenInfo> Tokens;
+  };
+
+  /// \brief The number of bytes of the predefines buffer these macros
+  /// replace.
+  unsigned PrefixSize;
+
+  /// \brief The definitions, in the order they appear in the buffer.
+  std::vector<Definition> Definitions;
+
+  explicit PreparsedMacros(unsigned PrefixSize) : PrefixSize(PrefixSize) {}
+};
+
+/// \brief A thread-safe, process-wide cache of PreparsedMacros, keyed by the
+/// exact predefines text they were parsed from.
+///
+/// The key is the text generated by InitializePreprocessor, which already
+/// captures everything the predefined macros depend on (target, language
+/// options, ...), so a hit is always valid.
+class PredefinesCache {
+public:
+  /// \brief Return the cached macros for \p Text, or null if there are none.
+  static std::shared_ptr<const PreparsedMacros> lookup(StringRef Text);
+
+  /// \brief Remember \p Macros as the macros defined by \p Text.
+  static void insert(StringRef Text,
+                     std::shared_ptr<const PreparsedMacros> Macros);
+
+  /// \brief Drop all cached entries.
+  static void clear();
+};
+
+} // end namespace clang
+
+#endif
@@ -30,9 +30,12 @@
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Registry.h"
+#include <deque>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -59,6 +62,7 @@ class PreprocessingRecord;
 class ModuleLoader;
 class PTHManager;
 class PreprocessorOptions;
+class PreparsedMacros;
 
 /// \brief Stores token information for comparing actual tokens with
 /// predefined values.  Only handles simple tokens and identifiers.
@@ -365,6 +369,14 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   /// encountered (e.g. a file is \#included, etc).
   std::unique_ptr<PPCallbacks> Callbacks;
 
+  /// \brief If set, called with each token returned by Lex(). Tokens
+  /// replayed after backtracking are not reported again.
+  std::function<void(const Token &)> OnToken;
+
+  /// \brief Whether OnToken is set. Lex() checks this plain flag on every
+  /// token instead of testing the std::function.
+  bool HasTokenWatcher;
+
   struct MacroExpandsInfo {
     Token Tok;
     MacroDefinition MD;
@@ -576,6 +588,61 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   MacroArgs *MacroArgCache;
   friend class MacroArgs;
 
+  /// \brief Changes whenever the macros that an identifier could expand to
+  /// may have changed: on every directive or pragma, and when macros are
+  /// defined, undefined or made visible.
+  unsigned MacroStateGeneration;
+
+  /// \brief The pre-expansion of a macro argument, recorded so that it can
+  /// be replayed for an identical argument of the same macro.
+  ///
+  /// Only arguments whose pre-expansion consists of object-like macro
+  /// expansions of the argument's own identifiers are recorded. Replaying
+  /// creates fresh macro expansion locations for the new argument.
+  struct PreExpandedArgument {
+    /// \brief A macro which was expanded, and the argument token naming it.
+    struct Expansion {
+      unsigned ArgToken;
+      MacroDefinition Definition;
+    };
+
+    /// \brief A macro expansion source location entry which was created.
+    struct Chunk {
+      unsigned ArgToken;
+      SourceLocation SpellingLoc;
+      unsigned Length;
+    };
+
+    /// \brief Where an expanded token came from: an argument token, or the
+    /// given offset into a chunk.
+    struct TokenOrigin {
+      bool FromArgument;
+      unsigned Index;
+      unsigned Offset;
+    };
+
+    std::vector<Token> Tokens;
+    std::vector<TokenOrigin> Origins;
+    SmallVector<Expansion, 2> Expansions;
+    SmallVector<Chunk, 2> Chunks;
+  };
+
+  /// \brief Recorded pre-expansions, keyed by the macro and the spelling of
+  /// the argument tokens. Only valid for PreExpandedArgsGeneration.
+  llvm::StringMap<PreExpandedArgument> PreExpandedArgs;
+  unsigned PreExpandedArgsGeneration;
+
+  /// \brief The macro expansions seen while pre-expanding a macro argument.
+  struct MacroArgPreExpansion {
+    SmallVector<std::pair<SourceLocation, MacroDefinition>, 2> Expansions;
+    bool Replayable;
+
+    MacroArgPreExpansion() : Replayable(true) {}
+  };
+
+  /// \brief The pre-expansion being recorded, if any.
+  MacroArgPreExpansion *CurMacroArgPreExpansion;
+
   /// For each IdentifierInfo used in a \#pragma push_macro directive,
   /// we keep a MacroInfo stack used to restore the previous macro value.
   llvm::DenseMap<IdentifierInfo*, std::vector<MacroInfo*> > PragmaPushMacroInfo;
@@ -586,6 +653,8 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   unsigned NumEnteredSourceFiles, MaxIncludeStackDepth;
   unsigned NumMacroExpanded, NumFnMacroExpanded, NumBuiltinMacroExpanded;
   unsigned NumFastMacroExpanded, NumTokenPaste, NumFastTokenPaste;
+  unsigned NumEmptyMacroExpanded, NumArgFreeFnMacroExpanded;
+  unsigned NumPreExpandedArgs, NumReplayedPreExpandedArgs;
   unsigned NumSkipped;
 
   /// \brief The predefined macros that preprocessor should use from the
@@ -595,6 +664,13 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   /// \brief The file ID for the preprocessor predefines.
   FileID PredefinesFileID;
 
+  /// \brief The size of the part of the predefines which may be shared with
+  /// other compilations through the PredefinesCache, or zero.
+  unsigned CacheablePredefinesSize;
+
+  /// \brief The cached macros installed for the cacheable predefines, if any.
+  std::shared_ptr<const PreparsedMacros> PreparsedPredefines;
+
   /// \{
   /// \brief Cache of macro expanders to reduce malloc traffic.
   enum { TokenLexerCacheSize = 8 };
@@ -620,24 +696,33 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   /// Cached tokens state.
   typedef SmallVector<Token, 1> CachedTokensTy;
 
-  /// \brief Cached tokens are stored here when we do backtracking or
-  /// lookahead. They are "lexed" by the CachingLex() method.
+  /// \brief The tokens lexed since the outermost EnableBacktrackAtThisPos(),
+  /// which a Backtrack() can return to.
+  ///
+  /// Nothing can return to these tokens once no backtrack positions remain,
+  /// so they are all released at that point.
   CachedTokensTy CachedTokens;
 
-  /// \brief The position of the cached token that CachingLex() should
-  /// "lex" next.
+  /// \brief Cached tokens which CachingLex() will "lex" next, the next one
+  /// first.
   ///
-  /// If it points beyond the CachedTokens vector, it means that a normal
+  /// These are tokens which were looked ahead at or backtracked over. Tokens
+  /// are taken from the front and put back at the front on Backtrack(), so
+  /// neither ever moves the other cached tokens. When this is empty, a normal
   /// Lex() should be invoked.
-  CachedTokensTy::size_type CachedLexPos;
+  std::deque<Token> CachedTokensAhead;
 
   /// \brief Stack of backtrack positions, allowing nested backtracks.
   ///
-  /// The EnableBacktrackAtThisPos() method pushes a position to
-  /// indicate where CachedLexPos should be set when the BackTrack() method is
-  /// invoked (at which point the last position is popped).
+  /// The EnableBacktrackAtThisPos() method pushes the current size of
+  /// CachedTokens; the BackTrack() method pops it and puts the tokens cached
+  /// since back in front of CachedTokensAhead.
   std::vector<CachedTokensTy::size_type> BacktrackPositions;
 
+  /// \brief Incremented each time all cached tokens have been consumed and
+  /// the token cache is emptied.
+  unsigned TokenCacheGeneration;
+
   struct MacroInfoChain {
     MacroInfo MI;
     MacroInfoChain *Next;
@@ -798,6 +883,13 @@ public:
   }
   /// \}
 
+  /// \brief Register a function to be called with each token returned by
+  /// Lex().
+  void setTokenWatcher(std::function<void(const Token &)> F) {
+    OnToken = std::move(F);
+    HasTokenWatcher = static_cast<bool>(OnToken);
+  }
+
   bool isMacroDefined(StringRef Id) {
     return isMacroDefined(&Identifiers.get(Id));
   }
@@ -939,6 +1031,22 @@ public:
   void setPredefines(const char *P) { Predefines = P; }
   void setPredefines(StringRef P) { Predefines = P; }
 
+  /// \brief Allow the first \p Size bytes of the predefines to be shared
+  /// through the PredefinesCache.
+  ///
+  /// They must start with a '# 1 "<built-in>" 3' line marker and otherwise
+  /// only contain \#defines. If an earlier compilation in this process parsed
+  /// the same text, its macros are installed instead of lexing the text again;
+  /// otherwise, the macros are added to the cache in EndSourceFile().
+  void setCacheablePredefinesSize(unsigned Size) {
+    CacheablePredefinesSize = Size;
+  }
+
+  /// \brief Record the macros defined by the first \p PrefixSize bytes of
+  /// the predefines, or return null if they cannot be recorded.
+  std::shared_ptr<const PreparsedMacros>
+  collectPredefinedMacros(unsigned PrefixSize) const;
+
   /// Return information about the specified preprocessor
   /// identifier token.
   IdentifierInfo *getIdentifierInfo(StringRef Name) const {
@@ -1093,6 +1201,18 @@ public:
   /// caching of tokens is on.
   bool isBacktrackEnabled() const { return !BacktrackPositions.empty(); }
 
+  /// \brief Identifies the current run of cached tokens.
+  ///
+  /// Tokens which were lexed while backtracking or looking ahead stay cached
+  /// until all of them have been consumed again, at which point the
+  /// generation changes. Clients can use this to tell that facts they
+  /// derived from cached tokens are about tokens that will not be seen again.
+  unsigned getTokenCacheGeneration() const { return TokenCacheGeneration; }
+
+  /// \brief The number of cached tokens that are still to be lexed again,
+  /// e.g. after a Backtrack().
+  unsigned getNumCachedTokensAhead() const { return CachedTokensAhead.size(); }
+
   /// \brief Lex the next token for this preprocessor.
   void Lex(Token &Result);
 
@@ -1173,8 +1293,8 @@ public:
   /// tokens after phase 5.  As such, it is equivalent to using
   /// 'Lex', not 'LexUnexpandedToken'.
   const Token &LookAhead(unsigned N) {
-    if (CachedLexPos + N < CachedTokens.size())
-      return CachedTokens[CachedLexPos+N];
+    if (N < CachedTokensAhead.size())
+      return CachedTokensAhead[N];
     else
       return PeekAhead(N+1);
   }
@@ -1187,11 +1307,14 @@ public:
   void RevertCachedTokens(unsigned N) {
     assert(isBacktrackEnabled() &&
            "Should only be called when tokens are cached for backtracking");
-    assert(signed(CachedLexPos) - signed(N) >= signed(BacktrackPositions.back())
-         && "Should revert tokens up to the last backtrack position, not more");
-    assert(signed(CachedLexPos) - signed(N) >= 0 &&
+    assert(signed(CachedTokens.size()) - signed(N) >=
+               signed(BacktrackPositions.back()) &&
+           "Should revert tokens up to the last backtrack position, not more");
+    assert(signed(CachedTokens.size()) - signed(N) >= 0 &&
            "Corrupted backtrack positions ?");
-    CachedLexPos -= N;
+    CachedTokensAhead.insert(CachedTokensAhead.begin(), CachedTokens.end() - N,
+                             CachedTokens.end());
+    CachedTokens.erase(CachedTokens.end() - N, CachedTokens.end());
   }
 
   /// \brief Enters a token in the token stream to be lexed next.
@@ -1200,7 +1323,7 @@ public:
   /// insertion point.
   void EnterToken(const Token &Tok) {
     EnterCachingLexMode();
-    CachedTokens.insert(CachedTokens.begin()+CachedLexPos, Tok);
+    CachedTokensAhead.push_front(Tok);
   }
 
   /// We notify the Preprocessor that if it is caching tokens (because
@@ -1213,23 +1336,22 @@ public:
   /// invoked.
   void AnnotateCachedTokens(const Token &Tok) {
     assert(Tok.isAnnotation() && "Expected annotation token");
-    if (CachedLexPos != 0 && isBacktrackEnabled())
+    if (!CachedTokens.empty() && isBacktrackEnabled())
       AnnotatePreviousCachedTokens(Tok);
   }
 
   /// Get the location of the last cached token, suitable for setting the end
   /// location of an annotation token.
   SourceLocation getLastCachedTokenLocation() const {
-    assert(CachedLexPos != 0);
-    return CachedTokens[CachedLexPos-1].getLastLoc();
+    assert(!CachedTokens.empty());
+    return CachedTokens.back().getLastLoc();
   }
 
-  /// \brief Whether \p Tok is the most recent token (`CachedLexPos - 1`) in
-  /// CachedTokens.
+  /// \brief Whether \p Tok is the most recent token in CachedTokens.
   bool IsPreviousCachedToken(const Token &Tok) const;
 
-  /// \brief Replace token in `CachedLexPos - 1` in CachedTokens by the tokens
-  /// in \p NewToks.
+  /// \brief Replace the most recent token in CachedTokens by the tokens in
+  /// \p NewToks.
   ///
   /// Useful when a token needs to be split in smaller ones and CachedTokens
   /// most recent token must to be updated to reflect that.
@@ -1245,16 +1367,16 @@ public:
   /// enabled.
   void ReplaceLastTokenWithAnnotation(const Token &Tok) {
     assert(Tok.isAnnotation() && "Expected annotation token");
-    if (CachedLexPos != 0 && isBacktrackEnabled())
-      CachedTokens[CachedLexPos-1] = Tok;
+    if (!CachedTokens.empty() && isBacktrackEnabled())
+      CachedTokens.back() = Tok;
   }
 
   /// Update the current token to represent the provided
   /// identifier, in order to cache an action performed by typo correction.
   void TypoCorrectToken(const Token &Tok) {
     assert(Tok.getIdentifierInfo() && "Expected identifier token");
-    if (CachedLexPos != 0 && isBacktrackEnabled())
-      CachedTokens[CachedLexPos-1] = Tok;
+    if (!CachedTokens.empty() && isBacktrackEnabled())
+      CachedTokens.back() = Tok;
   }
 
   /// \brief Recompute the current lexer kind based on the CurLexer/CurPTHLexer/
@@ -1802,6 +1924,20 @@ private:
   /// otherwise the caller should lex again.
   bool HandleMacroExpandedIdentifier(Token &Tok, const MacroDefinition &MD);
 
+  /// \brief Replay the recorded pre-expansion of the argument \p ArgTokens
+  /// (ending with an EOF) of \p MI into \p Result, if there is one.
+  ///
+  /// Otherwise, returns false and sets \p Key to the key to record the
+  /// pre-expansion under, or to the empty string if it can't be recorded.
+  bool replayPreExpandedArgument(const MacroInfo *MI, ArrayRef<Token> ArgTokens,
+                                 std::string &Key, std::vector<Token> &Result);
+
+  /// \brief Record the pre-expansion \p Expanded of \p ArgTokens under
+  /// \p Key, if it can be replayed.
+  void recordPreExpandedArgument(StringRef Key, ArrayRef<Token> ArgTokens,
+                                 ArrayRef<Token> Expanded,
+                                 const MacroArgPreExpansion &Record);
+
   /// \brief Cache macro expanded tokens for TokenLexers.
   //
   /// Works like a stack; a TokenLexer adds the macro expanded tokens that is
@@ -1843,6 +1979,10 @@ private:
   /// start getting tokens from it using the PTH cache.
   void EnterSourceFileWithPTH(PTHLexer *PL, const DirectoryLookup *Dir);
 
+  /// \brief Define the macros in \p Macros and skip over the part of the
+  /// predefines buffer they came from.
+  void installPreparsedPredefines(const PreparsedMacros &Macros);
+
   /// \brief Set the FileID for the preprocessor predefines.
   void setPredefinesFileID(FileID FID) {
     assert(PredefinesFileID.isInvalid() && "PredefinesFileID already set!");
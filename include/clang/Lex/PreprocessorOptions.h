@@ -50,6 +50,10 @@ public:
   /// predefines.
   unsigned UsePredefines : 1;
 
+  /// \brief Share the parsed compiler and target predefines with other
+  /// compilations in the same process (see PredefinesCache).
+  unsigned CachePredefines : 1;
+
   /// \brief Whether we should maintain a detailed record of all macro
   /// definitions and expansions.
   unsigned DetailedRecord : 1;
@@ -139,7 +143,8 @@ public:
   IntrusiveRefCntPtr<FailedModulesSet> FailedModules;
 
 public:
-  PreprocessorOptions() : UsePredefines(true), DetailedRecord(false),
+  PreprocessorOptions() : UsePredefines(true), CachePredefines(false),
+                          DetailedRecord(false),
                           DisablePCHValidation(false),
                           AllowPCHWithCompilerErrors(false),
                           DumpDeserializedPCHDecls(false),
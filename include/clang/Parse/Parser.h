@@ -23,6 +23,8 @@
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/LoopHint.h"
 #include "clang/Sema/Sema.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -87,6 +89,11 @@ class Parser : public CodeCompletionHandler {
   unsigned NumCachedScopes;
   Scope *ScopeCache[ScopeCacheSize];
 
+  /// \brief The number of scopes allocated and taken from the cache, and the
+  /// number of top-level declarations parsed, for -print-stats.
+  unsigned NumScopesAllocated, NumScopesReused;
+  unsigned NumTopLevelDecls;
+
   /// Identifiers used for SEH handling in Borland. These are only
   /// allowed in particular circumstances
   // __except block
@@ -289,6 +296,9 @@ public:
     return ParseTopLevelDecl(Result);
   }
 
+  /// \brief Print statistics about parsing to stderr.
+  void PrintStats() const;
+
   /// ConsumeToken - Consume the current 'peek token' and lex the next one.
   /// This does not work with special tokens: string literals, code completion
   /// and balanced tokens must be handled using the specific consume methods.
@@ -1230,6 +1240,7 @@ private:
   void ParseLexedMethodDeclaration(LateParsedMethodDeclaration &LM);
   void ParseLexedMethodDefs(ParsingClass &Class);
   void ParseLexedMethodDef(LexedMethod &LM);
+  bool canDelayLexedMethodDef(const LexedMethod &LM);
   void ParseLexedMemberInitializers(ParsingClass &Class);
   void ParseLexedMemberInitializer(LateParsedMemberInitializer &MI);
   void ParseLexedObjCMethodDefs(LexedMethod &LM, bool parseMethod);
@@ -2053,6 +2064,51 @@ private:
   /// during a tentative parse, but also should not be annotated as a non-type.
   bool isTentativelyDeclared(IdentifierInfo *II);
 
+  /// \brief The outcome of a disambiguating tentative parse.
+  struct TentativeParseOutcome {
+    TPResult Result;
+    bool IsAmbiguous;
+    /// The number of tokens the tentative parse looked at, which don't need
+    /// to be looked at again when the outcome is reused.
+    unsigned TokensScanned;
+  };
+
+  /// \brief Outcomes of the disambiguating tentative parses, keyed by the
+  /// kind of disambiguation and the location of the token it started at.
+  ///
+  /// The parser often disambiguates the same tokens twice: once inside an
+  /// enclosing tentative parse, and again after backtracking, when parsing
+  /// them for real. The outcomes are only kept while the tokens they are
+  /// about are still cached by the preprocessor, see
+  /// Preprocessor::getTokenCacheGeneration().
+  llvm::DenseMap<std::pair<unsigned, unsigned>, TentativeParseOutcome>
+      TentativeParseCache;
+  unsigned TentativeParseCacheGeneration;
+
+  unsigned NumTentativeParses;
+  unsigned NumTentativeParseCacheHits;
+  unsigned NumTokensNotRescanned;
+
+  /// \brief The inline member function bodies whose parsing was delayed
+  /// until they are used, and how many of them turned out to be used.
+  unsigned NumDelayedInlineMethods;
+  unsigned NumDelayedInlineMethodsParsed;
+
+  /// \brief The disambiguations whose outcomes are memoized.
+  enum TentativeParseKind {
+    TPK_SimpleDeclaration,
+    TPK_ForRangeDeclaration,
+    TPK_FunctionDeclarator,
+    TPK_TypeId // + TentativeCXXTypeIdContext
+  };
+
+  /// \brief Run \p Disambiguate, a tentative parse starting at the current
+  /// token which always backtracks, or reuse its outcome if it was already
+  /// run at this token.
+  TPResult
+  memoizeTentativeParse(unsigned Kind, bool &IsAmbiguous,
+                        llvm::function_ref<TPResult(bool &)> Disambiguate);
+
   // "Tentative parsing" functions, used for disambiguation. If a parsing error
   // is encountered they will return TPResult::Error.
   // Returning TPResult::True/False indicates that the ambiguity was
@@ -13,6 +13,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Rewrite/Core/DeltaTree.h"
 #include "clang/Rewrite/Core/RewriteRope.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace clang {
@@ -87,6 +88,32 @@ public:
   void ReplaceText(unsigned OrigOffset, unsigned OrigLength,
                    StringRef NewStr);
 
+  /// Edit - One change in a batch passed to applyEdits().  An edit with a
+  /// zero OrigLength inserts Text at OrigOffset, before or after any other
+  /// text inserted there; otherwise it replaces OrigLength bytes of the input
+  /// with Text.
+  struct Edit {
+    unsigned OrigOffset;
+    unsigned OrigLength;
+    StringRef Text;
+    bool InsertAfter;
+
+    Edit(unsigned OrigOffset, unsigned OrigLength, StringRef Text,
+         bool InsertAfter = true)
+      : OrigOffset(OrigOffset), OrigLength(OrigLength), Text(Text),
+        InsertAfter(InsertAfter) {}
+  };
+
+  /// applyEdits - Make all of the given edits, with the same result as
+  /// calling InsertText() or ReplaceText() for each of them in order.  The
+  /// edits may come in any order, but the ranges they replace must not
+  /// overlap each other or have text inserted inside them.  Large batches are
+  /// made in a single pass over the buffer, which is much faster than making
+  /// the edits one by one.
+  ///
+  /// Returns true, without making any of the edits, if some of them overlap.
+  bool applyEdits(ArrayRef<Edit> Edits);
+
 private:  // Methods only usable by Rewriter.
 
   /// getMappedOffset - Given an offset into the original SourceBuffer that this
@@ -467,6 +467,16 @@ public:
   /// that's used to parse every top-level function.
   SmallVector<sema::FunctionScopeInfo *, 4> FunctionScopes;
 
+  /// \brief Function scopes of nested functions which have been popped,
+  /// kept so that later nested functions reuse them and their storage.
+  SmallVector<sema::FunctionScopeInfo *, 4> CachedFunctionScopes;
+  enum { MaxCachedFunctionScopes = 8 };
+
+  /// \brief The number of function, block and lambda scopes allocated, and
+  /// the number of function scopes which reused an earlier one instead.
+  unsigned NumFunctionScopesAllocated;
+  unsigned NumFunctionScopesReused;
+
   typedef LazyVector<TypedefNameDecl *, ExternalSemaSource,
                      &ExternalSemaSource::ReadExtVectorDecls, 2, 2>
     ExtVectorDeclsType;
@@ -554,6 +564,11 @@ public:
       LateParsedTemplateMapT;
   LateParsedTemplateMapT LateParsedTemplateMap;
 
+  /// \brief Inline member functions whose parsing was delayed until they are
+  /// used (-fdelayed-inline-method-parsing), and which have been used. They
+  /// are parsed at the end of the translation unit.
+  SmallVector<FunctionDecl *, 8> PendingDelayedInlineMethods;
+
   /// \brief Callback to the parser to parse templated functions when needed.
   typedef void LateTemplateParserCB(void *P, LateParsedTemplate &LPT);
   typedef void LateTemplateParserCleanupCB(void *P);
@@ -5483,6 +5498,7 @@ public:
   void MarkAsLateParsedTemplate(FunctionDecl *FD, Decl *FnD,
                                 CachedTokens &Toks);
   void UnmarkAsLateParsedTemplate(FunctionDecl *FD);
+  bool ParsePendingDelayedInlineMethods();
   bool IsInsideALocalClassWithinATemplateFunction();
 
   Decl *ActOnStaticAssertDeclaration(SourceLocation StaticAssertLoc,
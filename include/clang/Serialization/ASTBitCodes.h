@@ -580,7 +580,13 @@ namespace clang {
       MSSTRUCT_PRAGMA_OPTIONS = 55,
 
       /// \brief Record code for \#pragma ms_struct options.
-      POINTERS_TO_MEMBERS_PRAGMA_OPTIONS = 56
+      POINTERS_TO_MEMBERS_PRAGMA_OPTIONS = 56,
+
+      /// \brief Record code for the starting offsets of the source location
+      /// entries, relative to the start of this module's source locations.
+      ///
+      /// Lets the source manager search the entries without loading them.
+      SOURCE_LOCATION_STARTS = 57
     };
 
     /// \brief Record types used within a source manager block.
@@ -601,7 +607,10 @@ namespace clang {
       SM_SLOC_BUFFER_BLOB_COMPRESSED = 4,
       /// \brief Describes a source location entry (SLocEntry) for a
       /// macro expansion.
-      SM_SLOC_EXPANSION_ENTRY = 5
+      SM_SLOC_EXPANSION_ENTRY = 5,
+      /// \brief Describes the offsets of the lines of a file. This kind of
+      /// record optionally follows a SM_SLOC_FILE_ENTRY record.
+      SM_SLOC_LINE_TABLE = 6
     };
 
     /// \brief Record types used within a preprocessor block.
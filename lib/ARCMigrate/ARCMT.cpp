@@ -20,8 +20,13 @@
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/Sema/SemaDiagnostic.h"
 #include "clang/Serialization/ASTReader.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <thread>
 #include <utility>
 using namespace clang;
 using namespace arcmt;
@@ -401,6 +406,349 @@ bool arcmt::migrateWithTemporaryFiles(
                          emitPremigrationARCErrors, plistOut);
 }
 
+//===----------------------------------------------------------------------===//
+// migrateInParallel.
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// \brief A change replacing the lines [Begin, End) of some original text.
+struct LineHunk {
+  unsigned Begin, End;
+  ArrayRef<StringRef> NewLines;
+};
+
+/// \brief The migration of one of the inputs of migrateInParallel().
+struct InputMigration {
+  FrontendInputFile Input;
+  CompilerInvocation CI;
+  std::string DiagText;
+  std::unique_ptr<MigrationProcess> Migration;
+  bool HadErrors;
+
+  InputMigration(const CompilerInvocation &CI, const FrontendInputFile &Input)
+    : Input(Input), CI(CI), HadErrors(false) { }
+};
+
+/// \brief The changes migrateInParallel() merged into a file.
+struct MergedFile {
+  bool Changed;
+  std::string Text;
+  /// \brief What the file contained before migrating, loaded when a second
+  /// input changes it.
+  std::unique_ptr<llvm::MemoryBuffer> Base;
+
+  MergedFile() : Changed(false) { }
+};
+
+} // end anonymous namespace
+
+/// \brief Splits \p Text into lines, keeping their line terminators.
+static void splitLines(StringRef Text, SmallVectorImpl<StringRef> &Lines) {
+  while (!Text.empty()) {
+    size_t Length = std::min(Text.find('\n'), Text.size() - 1) + 1;
+    Lines.push_back(Text.substr(0, Length));
+    Text = Text.substr(Length);
+  }
+}
+
+/// \brief The most lines diffLines() inserts and removes before it gives up
+/// and describes the difference as a single change.
+enum { MaxLineDiffEdits = 2000 };
+
+/// \brief Computes the changes turning \p Old into \p New, with Myers' O(ND)
+/// difference algorithm.
+static void diffLines(ArrayRef<StringRef> Old, ArrayRef<StringRef> New,
+                      SmallVectorImpl<LineHunk> &Hunks) {
+  // Migration changes few lines, so most of the text is a common prefix and
+  // suffix.
+  unsigned Prefix = 0;
+  while (Prefix < Old.size() && Prefix < New.size() &&
+         Old[Prefix] == New[Prefix])
+    ++Prefix;
+  unsigned Suffix = 0;
+  while (Suffix < Old.size() - Prefix && Suffix < New.size() - Prefix &&
+         Old[Old.size() - Suffix - 1] == New[New.size() - Suffix - 1])
+    ++Suffix;
+  ArrayRef<StringRef> A = Old.slice(Prefix, Old.size() - Prefix - Suffix);
+  ArrayRef<StringRef> B = New.slice(Prefix, New.size() - Prefix - Suffix);
+  if (A.empty() && B.empty())
+    return;
+
+  int N = A.size(), M = B.size();
+  int MaxD = std::min(N + M, int(MaxLineDiffEdits));
+
+  // V[Offset + K] is the furthest X reached on the diagonal K = X - Y, and
+  // Trace[D] holds V[Offset - D] ... V[Offset + D] after D edits.
+  int Offset = MaxD + 1;
+  std::vector<int> V(2 * MaxD + 3, 0);
+  std::vector<std::vector<int> > Trace;
+  int FoundD = -1;
+  for (int D = 0; D <= MaxD && FoundD < 0; ++D) {
+    for (int K = -D; K <= D; K += 2) {
+      int X;
+      if (K == -D || (K != D && V[Offset + K - 1] < V[Offset + K + 1]))
+        X = V[Offset + K + 1];
+      else
+        X = V[Offset + K - 1] + 1;
+      int Y = X - K;
+      while (X < N && Y < M && A[X] == B[Y])
+        ++X, ++Y;
+      V[Offset + K] = X;
+      if (X >= N && Y >= M) {
+        FoundD = D;
+        break;
+      }
+    }
+    Trace.emplace_back(V.begin() + Offset - D, V.begin() + Offset + D + 1);
+  }
+
+  if (FoundD < 0) {
+    Hunks.push_back({Prefix, Prefix + N, B});
+    return;
+  }
+
+  // Walk back from the end, collecting the lines the texts have in common.
+  SmallVector<std::pair<int, int>, 64> Matches;
+  int X = N, Y = M;
+  for (int D = FoundD; D >= 0; --D) {
+    int K = X - Y;
+    int PrevX = 0, PrevY = 0, SnakeX = 0;
+    if (D > 0) {
+      const std::vector<int> &Prev = Trace[D - 1];
+      bool Down = K == -D || (K != D && Prev[K - 1 + D - 1] <
+                                            Prev[K + 1 + D - 1]);
+      int PrevK = Down ? K + 1 : K - 1;
+      PrevX = Prev[PrevK + D - 1];
+      PrevY = PrevX - PrevK;
+      SnakeX = Down ? PrevX : PrevX + 1;
+    }
+    for (; X > SnakeX; --X, --Y)
+      Matches.push_back(std::make_pair(X - 1, Y - 1));
+    X = PrevX;
+    Y = PrevY;
+  }
+  std::reverse(Matches.begin(), Matches.end());
+  Matches.push_back(std::make_pair(N, M));
+
+  int OldPos = 0, NewPos = 0;
+  for (const auto &Match : Matches) {
+    if (Match.first > OldPos || Match.second > NewPos)
+      Hunks.push_back({Prefix + OldPos, Prefix + Match.first,
+                       B.slice(NewPos, Match.second - NewPos)});
+    OldPos = Match.first + 1;
+    NewPos = Match.second + 1;
+  }
+}
+
+static bool hunksOverlap(const LineHunk &LHS, const LineHunk &RHS) {
+  // Two insertions at the same line conflict since neither order is right.
+  if (LHS.Begin == RHS.Begin)
+    return true;
+  return LHS.Begin < RHS.End && RHS.Begin < LHS.End;
+}
+
+/// \brief Merges the changes \p Ours and \p Theirs made to \p Base into
+/// \p Result.
+///
+/// \returns true if they change the same lines differently.
+static bool mergeChanges(StringRef Base, StringRef Ours, StringRef Theirs,
+                         std::string &Result) {
+  SmallVector<StringRef, 256> BaseLines, OurLines, TheirLines;
+  splitLines(Base, BaseLines);
+  splitLines(Ours, OurLines);
+  splitLines(Theirs, TheirLines);
+
+  SmallVector<LineHunk, 8> OurHunks, TheirHunks;
+  diffLines(BaseLines, OurLines, OurHunks);
+  diffLines(BaseLines, TheirLines, TheirHunks);
+
+  Result.clear();
+  unsigned Pos = 0;
+  auto apply = [&](const LineHunk &Hunk) {
+    for (; Pos < Hunk.Begin; ++Pos)
+      Result += BaseLines[Pos];
+    for (StringRef Line : Hunk.NewLines)
+      Result += Line;
+    Pos = Hunk.End;
+  };
+
+  const LineHunk *O = OurHunks.begin(), *OE = OurHunks.end();
+  const LineHunk *T = TheirHunks.begin(), *TE = TheirHunks.end();
+  while (O != OE || T != TE) {
+    if (O != OE && T != TE && hunksOverlap(*O, *T)) {
+      if (O->Begin != T->Begin || O->End != T->End ||
+          !O->NewLines.equals(T->NewLines))
+        return true;
+      // Both made the same change.
+      ++T;
+      continue;
+    }
+    if (T == TE || (O != OE && O->Begin < T->Begin))
+      apply(*O++);
+    else
+      apply(*T++);
+  }
+  for (; Pos < BaseLines.size(); ++Pos)
+    Result += BaseLines[Pos];
+  return false;
+}
+
+static void migrateInput(InputMigration &Job,
+                         std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                         StringRef outputDir) {
+  llvm::raw_string_ostream DiagOS(Job.DiagText);
+  TextDiagnosticPrinter DiagClient(DiagOS, &Job.CI.getDiagnosticOpts());
+
+  // Make sure checking is successful first.
+  CompilerInvocation CInvokForCheck(Job.CI);
+  if (arcmt::checkForManualIssues(CInvokForCheck, Job.Input, PCHContainerOps,
+                                  &DiagClient)) {
+    Job.HadErrors = true;
+    return;
+  }
+
+  CompilerInvocation CInvok(Job.CI);
+  CInvok.getFrontendOpts().Inputs.clear();
+  CInvok.getFrontendOpts().Inputs.push_back(Job.Input);
+
+  Job.Migration.reset(
+      new MigrationProcess(CInvok, PCHContainerOps, &DiagClient, outputDir));
+  std::vector<TransformFn> transforms = arcmt::getAllTransformations(
+      Job.CI.getLangOpts()->getGC(),
+      Job.CI.getMigratorOpts().NoFinalizeRemoval);
+  assert(!transforms.empty());
+
+  for (unsigned i = 0, e = transforms.size(); i != e; ++i) {
+    if (Job.Migration->applyTransform(transforms[i])) {
+      Job.HadErrors = true;
+      break;
+    }
+  }
+
+  // The unit refers to DiagClient, and only the remapped files are needed
+  // from now on.
+  Job.Migration->discardParsedUnit();
+}
+
+bool arcmt::migrateInParallel(
+    CompilerInvocation &origCI, ArrayRef<FrontendInputFile> Inputs,
+    std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+    raw_ostream &DiagOS, StringRef outputDir, unsigned NumThreads) {
+  if (!origCI.getLangOpts()->ObjC1 || Inputs.empty())
+    return false;
+
+  // Each job gets its own copy of the invocation up front; the copies share
+  // nothing with each other.
+  std::vector<std::unique_ptr<InputMigration> > Jobs;
+  for (const FrontendInputFile &Input : Inputs)
+    Jobs.emplace_back(new InputMigration(origCI, Input));
+
+  if (!NumThreads)
+    NumThreads = std::thread::hardware_concurrency();
+  NumThreads = std::max(1u, std::min<unsigned>(NumThreads, Jobs.size()));
+  {
+    llvm::ThreadPool Pool(NumThreads);
+    for (auto &Job : Jobs) {
+      InputMigration *J = Job.get();
+      Pool.async([J, &PCHContainerOps, outputDir] {
+        migrateInput(*J, PCHContainerOps, outputDir);
+      });
+    }
+    Pool.wait();
+  }
+
+  bool HadErrors = false;
+  for (const auto &Job : Jobs) {
+    DiagOS << Job->DiagText;
+    HadErrors |= Job->HadErrors;
+  }
+  if (HadErrors)
+    return true;
+
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
+      new DiagnosticsEngine(DiagID, &origCI.getDiagnosticOpts(),
+                            new TextDiagnosticPrinter(
+                                DiagOS, &origCI.getDiagnosticOpts())));
+
+  // Start from the files as every job saw them.
+  FileRemapper Remapper;
+  if (!outputDir.empty())
+    Remapper.initFromDisk(outputDir, *Diags, /*ignoreIfFilesChanged=*/true);
+  llvm::StringMap<std::string> BaseFiles;
+  {
+    PreprocessorOptions PPOpts;
+    Remapper.applyMappings(PPOpts);
+    for (const auto &RF : PPOpts.RemappedFiles) {
+      SmallString<128> Path(RF.first);
+      llvm::sys::fs::make_absolute(Path);
+      BaseFiles[Path] = RF.second;
+    }
+  }
+
+  llvm::StringMap<MergedFile> MergedFiles;
+  bool HadConflicts = false;
+  for (const auto &Job : Jobs) {
+    PreprocessorOptions PPOpts;
+    Job->Migration->getRemapper().applyMappings(PPOpts);
+    for (const auto &RB : PPOpts.RemappedFileBuffers) {
+      SmallString<128> Path(RB.first);
+      llvm::sys::fs::make_absolute(Path);
+      StringRef NewText = RB.second->getBuffer();
+
+      MergedFile &File = MergedFiles[Path];
+      if (!File.Changed) {
+        File.Changed = true;
+        File.Text = NewText.str();
+        continue;
+      }
+      if (File.Text == NewText)
+        continue;
+
+      if (!File.Base) {
+        llvm::StringMap<std::string>::iterator Known = BaseFiles.find(Path);
+        StringRef BasePath =
+            Known != BaseFiles.end() ? StringRef(Known->second) : Path.str();
+        llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer> > Buf =
+            llvm::MemoryBuffer::getFile(BasePath);
+        if (!Buf) {
+          Diags->Report(Diags->getCustomDiagID(DiagnosticsEngine::Error,
+                                               "could not read '%0'"))
+              << BasePath;
+          return true;
+        }
+        File.Base = std::move(*Buf);
+      }
+
+      std::string Merged;
+      if (mergeChanges(File.Base->getBuffer(), File.Text, NewText, Merged)) {
+        Diags->Report(Diags->getCustomDiagID(
+            DiagnosticsEngine::Error,
+            "migrating '%0' changes '%1' in a way that conflicts with the "
+            "migration of other files"))
+            << Job->Input.getFile() << Path;
+        HadConflicts = true;
+        continue;
+      }
+      File.Text = std::move(Merged);
+    }
+  }
+  if (HadConflicts)
+    return true;
+
+  for (const auto &File : MergedFiles)
+    Remapper.remap(File.getKey(),
+                   llvm::MemoryBuffer::getMemBufferCopy(
+                       File.getValue().Text, File.getKey() + "-trans"));
+
+  if (outputDir.empty()) {
+    origCI.getLangOpts()->ObjCAutoRefCount = true;
+    return Remapper.overwriteOriginal(*Diags);
+  }
+  return Remapper.flushToDisk(outputDir, *Diags);
+}
+
 bool arcmt::getFileRemappings(std::vector<std::pair<std::string,std::string> > &
                                   remap,
                               StringRef outputDir,
@@ -506,12 +854,30 @@ public:
 /// \brief Anchor for VTable.
 MigrationProcess::RewriteListener::~RewriteListener() { }
 
+struct MigrationProcess::ParsedUnit {
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags;
+  /// \brief The diagnostics captured while parsing. Transforms clear the
+  /// diagnostics they take care of, so each one works on its own copy.
+  CapturedDiagList CapturedDiags;
+  std::vector<SourceLocation> ARCMTMacroLocs;
+  /// \brief The CaptureDiagnosticConsumer used while parsing.
+  std::unique_ptr<DiagnosticConsumer> Capture;
+  std::unique_ptr<ASTUnit> Unit;
+
+  void finishCapture() {
+    if (Capture)
+      static_cast<CaptureDiagnosticConsumer *>(Capture.get())->FinishCapture();
+  }
+
+  ~ParsedUnit() { finishCapture(); }
+};
+
 MigrationProcess::MigrationProcess(
     const CompilerInvocation &CI,
     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
     DiagnosticConsumer *diagClient, StringRef outputDir)
     : OrigCI(CI), PCHContainerOps(std::move(PCHContainerOps)),
-      DiagClient(diagClient), HadARCErrors(false) {
+      DiagClient(diagClient), NumParses(0), HadARCErrors(false) {
   if (!outputDir.empty()) {
     IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
     IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
@@ -521,66 +887,82 @@ MigrationProcess::MigrationProcess(
   }
 }
 
-bool MigrationProcess::applyTransform(TransformFn trans,
-                                      RewriteListener *listener) {
-  std::unique_ptr<CompilerInvocation> CInvok;
-  CInvok.reset(
-      createInvocationForMigration(OrigCI, PCHContainerOps->getRawReader()));
-  CInvok->getDiagnosticOpts().IgnoreWarnings = true;
-
-  Remapper.applyMappings(CInvok->getPreprocessorOpts());
+MigrationProcess::~MigrationProcess() { }
 
-  CapturedDiagList capturedDiags;
-  std::vector<SourceLocation> ARCMTMacroLocs;
+void MigrationProcess::discardParsedUnit() {
+  LastUnit.reset();
+}
 
+bool MigrationProcess::applyTransform(TransformFn trans,
+                                      RewriteListener *listener) {
   assert(DiagClient);
-  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
-  IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
-      new DiagnosticsEngine(DiagID, new DiagnosticOptions,
-                            DiagClient, /*ShouldOwnClient=*/false));
 
-  // Filter of all diagnostics.
-  CaptureDiagnosticConsumer errRec(*Diags, *DiagClient, capturedDiags);
-  Diags->setClient(&errRec, /*ShouldOwnClient=*/false);
+  if (!LastUnit) {
+    std::unique_ptr<CompilerInvocation> CInvok;
+    CInvok.reset(
+        createInvocationForMigration(OrigCI, PCHContainerOps->getRawReader()));
+    CInvok->getDiagnosticOpts().IgnoreWarnings = true;
 
-  std::unique_ptr<ARCMTMacroTrackerAction> ASTAction;
-  ASTAction.reset(new ARCMTMacroTrackerAction(ARCMTMacroLocs));
+    Remapper.applyMappings(CInvok->getPreprocessorOpts());
 
-  std::unique_ptr<ASTUnit> Unit(ASTUnit::LoadFromCompilerInvocationAction(
-      CInvok.release(), PCHContainerOps, Diags, ASTAction.get()));
-  if (!Unit) {
-    errRec.FinishCapture();
-    return true;
-  }
-  Unit->setOwnsRemappedFileBuffers(false); // FileRemapper manages that.
+    std::unique_ptr<ParsedUnit> Parsed(new ParsedUnit());
+    IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+    Parsed->Diags = new DiagnosticsEngine(DiagID, new DiagnosticOptions,
+                                          DiagClient, /*ShouldOwnClient=*/false);
+    DiagnosticsEngine &Diags = *Parsed->Diags;
+
+    // Filter of all diagnostics.
+    Parsed->Capture.reset(new CaptureDiagnosticConsumer(
+        Diags, *DiagClient, Parsed->CapturedDiags));
+    Diags.setClient(Parsed->Capture.get(), /*ShouldOwnClient=*/false);
+
+    std::unique_ptr<ARCMTMacroTrackerAction> ASTAction;
+    ASTAction.reset(new ARCMTMacroTrackerAction(Parsed->ARCMTMacroLocs));
+
+    ++NumParses;
+    Parsed->Unit.reset(ASTUnit::LoadFromCompilerInvocationAction(
+        CInvok.release(), PCHContainerOps, Parsed->Diags, ASTAction.get()));
+    if (!Parsed->Unit)
+      return true;
+    Parsed->Unit->setOwnsRemappedFileBuffers(false); // FileRemapper manages that.
 
-  HadARCErrors = HadARCErrors || capturedDiags.hasErrors();
+    HadARCErrors = HadARCErrors || Parsed->CapturedDiags.hasErrors();
 
-  // Don't filter diagnostics anymore.
-  Diags->setClient(DiagClient, /*ShouldOwnClient=*/false);
+    // Don't filter diagnostics anymore.
+    Diags.setClient(DiagClient, /*ShouldOwnClient=*/false);
 
-  ASTContext &Ctx = Unit->getASTContext();
+    if (Diags.hasFatalErrorOccurred()) {
+      ASTUnit &Unit = *Parsed->Unit;
+      Diags.Reset();
+      DiagClient->BeginSourceFile(Unit.getASTContext().getLangOpts(),
+                                  &Unit.getPreprocessor());
+      Parsed->CapturedDiags.reportDiagnostics(Diags);
+      DiagClient->EndSourceFile();
+      return true;
+    }
 
-  if (Diags->hasFatalErrorOccurred()) {
-    Diags->Reset();
-    DiagClient->BeginSourceFile(Ctx.getLangOpts(), &Unit->getPreprocessor());
-    capturedDiags.reportDiagnostics(*Diags);
-    DiagClient->EndSourceFile();
-    errRec.FinishCapture();
-    return true;
+    LastUnit = std::move(Parsed);
   }
 
+  // Parsing again is only needed once a transform changes the files, so
+  // drop the unit unless this one turns out not to.
+  std::unique_ptr<ParsedUnit> Parsed = std::move(LastUnit);
+  DiagnosticsEngine &Diags = *Parsed->Diags;
+  ASTUnit &Unit = *Parsed->Unit;
+  ASTContext &Ctx = Unit.getASTContext();
+  CapturedDiagList capturedDiags = Parsed->CapturedDiags;
+
   // After parsing of source files ended, we want to reuse the
   // diagnostics objects to emit further diagnostics.
   // We call BeginSourceFile because DiagnosticConsumer requires that 
   // diagnostics with source range information are emitted only in between
   // BeginSourceFile() and EndSourceFile().
-  DiagClient->BeginSourceFile(Ctx.getLangOpts(), &Unit->getPreprocessor());
+  DiagClient->BeginSourceFile(Ctx.getLangOpts(), &Unit.getPreprocessor());
 
   Rewriter rewriter(Ctx.getSourceManager(), Ctx.getLangOpts());
-  TransformActions TA(*Diags, capturedDiags, Ctx, Unit->getPreprocessor());
+  TransformActions TA(Diags, capturedDiags, Ctx, Unit.getPreprocessor());
   MigrationPass pass(Ctx, OrigCI.getLangOpts()->getGC(),
-                     Unit->getSema(), TA, capturedDiags, ARCMTMacroLocs);
+                     Unit.getSema(), TA, capturedDiags, Parsed->ARCMTMacroLocs);
 
   trans(pass);
 
@@ -590,11 +972,16 @@ bool MigrationProcess::applyTransform(TransformFn trans,
   }
 
   DiagClient->EndSourceFile();
-  errRec.FinishCapture();
+  Parsed->finishCapture();
 
   if (DiagClient->getNumErrors())
     return true;
 
+  if (rewriter.buffer_begin() == rewriter.buffer_end()) {
+    LastUnit = std::move(Parsed);
+    return false;
+  }
+
   for (Rewriter::buffer_iterator
         I = rewriter.buffer_begin(), E = rewriter.buffer_end(); I != E; ++I) {
     FileID FID = I->first;
@@ -610,7 +997,7 @@ bool MigrationProcess::applyTransform(TransformFn trans,
         llvm::MemoryBuffer::getMemBufferCopy(
             StringRef(newText.data(), newText.size()), newFname));
     SmallString<64> filePath(file->getName());
-    Unit->getFileManager().FixupRelativePath(filePath);
+    Unit.getFileManager().FixupRelativePath(filePath);
     Remapper.remap(filePath.str(), std::move(memBuf));
   }
 
@@ -1742,17 +1742,60 @@ bool ObjCMigrateASTConsumer::InsertFoundation(ASTContext &Ctx,
 
 namespace {
 
+/// \brief Collects the edits for each file, and makes them in one batch per
+/// file when \c finish() is called.
 class RewritesReceiver : public edit::EditsReceiver {
   Rewriter &Rewrite;
 
+  struct PendingEdit {
+    unsigned Offset;
+    unsigned Length;
+    std::string Text;
+  };
+  std::map<FileID, std::vector<PendingEdit> > Edits;
+
+  void addEdit(SourceLocation loc, unsigned length, StringRef text) {
+    if (!Rewriter::isRewritable(loc))
+      return;
+    std::pair<FileID, unsigned> locInfo =
+        Rewrite.getSourceMgr().getDecomposedLoc(loc);
+    PendingEdit edit = { locInfo.second, length, text.str() };
+    Edits[locInfo.first].push_back(std::move(edit));
+  }
+
 public:
   RewritesReceiver(Rewriter &Rewrite) : Rewrite(Rewrite) { }
 
   void insert(SourceLocation loc, StringRef text) override {
-    Rewrite.InsertText(loc, text);
+    addEdit(loc, 0, text);
   }
   void replace(CharSourceRange range, StringRef text) override {
-    Rewrite.ReplaceText(range.getBegin(), Rewrite.getRangeSize(range), text);
+    int size = Rewrite.getRangeSize(range);
+    if (size >= 0)
+      addEdit(range.getBegin(), size, text);
+  }
+
+  /// \brief Make all of the edits received so far.
+  void finish() {
+    for (auto &fileEdits : Edits) {
+      SmallVector<RewriteBuffer::Edit, 64> batch;
+      for (const PendingEdit &edit : fileEdits.second)
+        batch.push_back(RewriteBuffer::Edit(edit.Offset, edit.Length,
+                                            edit.Text));
+      RewriteBuffer &buf = Rewrite.getEditBuffer(fileEdits.first);
+      if (!buf.applyEdits(batch))
+        continue;
+
+      // The edited source should never produce overlapping edits; if it
+      // does, make them one at a time as they were received.
+      for (const RewriteBuffer::Edit &edit : batch) {
+        if (edit.OrigLength)
+          buf.ReplaceText(edit.OrigOffset, edit.OrigLength, edit.Text);
+        else
+          buf.InsertText(edit.OrigOffset, edit.Text);
+      }
+    }
+    Edits.clear();
   }
 };
 
@@ -1953,6 +1996,7 @@ void ObjCMigrateASTConsumer::HandleTranslationUnit(ASTContext &Ctx) {
   Rewriter rewriter(Ctx.getSourceManager(), Ctx.getLangOpts());
   RewritesReceiver Rec(rewriter);
   Editor->applyRewrites(Rec);
+  Rec.finish();
 
   for (Rewriter::buffer_iterator
         I = rewriter.buffer_begin(), E = rewriter.buffer_end(); I != E; ++I) {
@@ -2190,6 +2234,7 @@ static std::string applyEditsToTemp(const FileEntry *FE,
   Rewriter rewriter(SM, LangOpts);
   RewritesReceiver Rec(rewriter);
   Editor.applyRewrites(Rec);
+  Rec.finish();
 
   const RewriteBuffer *Buf = rewriter.getRewriteBufferFor(FID);
   SmallString<512> NewText;
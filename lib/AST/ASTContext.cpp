@@ -876,6 +876,23 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  // Name lookup tables.
+  unsigned NumLookupTables = 0, NumIndexedLookupTables = 0;
+  unsigned NumLookupEntries = 0;
+  size_t LookupTableBytes = 0;
+  for (StoredDeclsMap *Map = LastSDM.getPointer(); Map;
+       Map = Map->Previous.getPointer()) {
+    ++NumLookupTables;
+    if (Map->isIndexed())
+      ++NumIndexedLookupTables;
+    NumLookupEntries += Map->size();
+    LookupTableBytes += Map->getMemorySize();
+  }
+  llvm::errs() << NumLookupTables << " name lookup tables, "
+               << NumIndexedLookupTables << " of them hashed, with "
+               << NumLookupEntries << " names in " << LookupTableBytes
+               << " bytes\n";
+
   if (ExternalSource) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
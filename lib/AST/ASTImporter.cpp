@@ -15,6 +15,7 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclLookups.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/AST/StmtVisitor.h"
@@ -22,6 +23,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 #include <deque>
 
 namespace clang {
@@ -87,6 +89,7 @@ namespace clang {
     void ImportDeclarationNameLoc(const DeclarationNameInfo &From,
                                   DeclarationNameInfo& To);
     void ImportDeclContext(DeclContext *FromDC, bool ForceImport = false);
+    bool ImportDeclContextLazily(DeclContext *FromDC, DeclContext *ToDC);
 
     typedef DesignatedInitExpr::Designator Designator;
     Designator ImportDesignator(const Designator &D);
@@ -305,6 +308,11 @@ namespace {
     /// \brief Declaration (from, to) pairs that are known not to be equivalent
     /// (which we have already complained about).
     llvm::DenseSet<std::pair<Decl *, Decl *> > &NonEquivalentDecls;
+
+    /// \brief Canonical declaration (from, to) pairs that an earlier check
+    /// proved to be equivalent. Pairs proven by this check are added once it
+    /// succeeds.
+    llvm::DenseSet<std::pair<Decl *, Decl *> > &EquivalentDecls;
     
     /// \brief Whether we're being strict about the spelling of types when 
     /// unifying two types.
@@ -318,9 +326,11 @@ namespace {
 
     StructuralEquivalenceContext(ASTContext &C1, ASTContext &C2,
                llvm::DenseSet<std::pair<Decl *, Decl *> > &NonEquivalentDecls,
+               llvm::DenseSet<std::pair<Decl *, Decl *> > &EquivalentDecls,
                                  bool StrictTypeSpelling = false,
                                  bool Complain = true)
       : C1(C1), C2(C2), NonEquivalentDecls(NonEquivalentDecls),
+        EquivalentDecls(EquivalentDecls),
         StrictTypeSpelling(StrictTypeSpelling), Complain(Complain),
         LastDiagFromC2(false) {}
 
@@ -1406,12 +1416,28 @@ static bool IsStructurallyEquivalent(StructuralEquivalenceContext &Context,
   if (EquivToD1)
     return EquivToD1 == D2->getCanonicalDecl();
   
-  // Produce a tentative equivalence D1 <-> D2, which will be checked later.
+  // Produce a tentative equivalence D1 <-> D2, which will be checked later
+  // unless an earlier check already proved it.
   EquivToD1 = D2->getCanonicalDecl();
-  Context.DeclsToCheck.push_back(D1->getCanonicalDecl());
+  if (!Context.EquivalentDecls.count(std::make_pair(D1->getCanonicalDecl(),
+                                                    EquivToD1)))
+    Context.DeclsToCheck.push_back(D1->getCanonicalDecl());
   return true;
 }
 
+/// \brief Determine whether comparing \p D with another declaration may give
+/// a different answer later, because \p D is a tag (or the pattern of a class
+/// template) whose definition is not complete yet.
+static bool mayBeCompletedLater(Decl *D) {
+  if (ClassTemplateDecl *Template = dyn_cast<ClassTemplateDecl>(D))
+    D = Template->getTemplatedDecl();
+  if (TagDecl *Tag = dyn_cast<TagDecl>(D)) {
+    TagDecl *Definition = Tag->getDefinition();
+    return !Definition || Definition->isBeingDefined();
+  }
+  return false;
+}
+
 bool StructuralEquivalenceContext::IsStructurallyEquivalent(Decl *D1, 
                                                             Decl *D2) {
   if (!::IsStructurallyEquivalent(*this, D1, D2))
@@ -1429,6 +1455,10 @@ bool StructuralEquivalenceContext::IsStructurallyEquivalent(QualType T1,
 }
 
 bool StructuralEquivalenceContext::Finish() {
+  // The declarations checked so far, in order.
+  SmallVector<Decl *, 8> Checked;
+  bool Cacheable = true;
+
   while (!DeclsToCheck.empty()) {
     // Check the next declaration.
     Decl *D1 = DeclsToCheck.front();
@@ -1534,8 +1564,17 @@ bool StructuralEquivalenceContext::Finish() {
       return true;
     }
     // FIXME: Check other declaration kinds!
+
+    Checked.push_back(D1);
+    if (mayBeCompletedLater(D1) || mayBeCompletedLater(D2))
+      Cacheable = false;
   }
-  
+
+  // Every tentative equivalence held, so remember them for later checks.
+  // Incomplete tags compare equal to anything, so don't remember those.
+  if (Cacheable)
+    for (Decl *D1 : Checked)
+      EquivalentDecls.insert(std::make_pair(D1, TentativeEquivalences[D1]));
   return false;
 }
 
@@ -2096,6 +2135,38 @@ void ASTNodeImporter::ImportDeclContext(DeclContext *FromDC, bool ForceImport) {
     Importer.Import(From);
 }
 
+/// \brief Arrange for the members of \p FromDC to be imported into \p ToDC
+/// when they are looked up, if the importer imports members lazily.
+///
+/// \returns false if the members have to be imported now.
+bool ASTNodeImporter::ImportDeclContextLazily(DeclContext *FromDC,
+                                              DeclContext *ToDC) {
+  if (!Importer.isLazyMemberImport() || Importer.isMinimalImport() ||
+      !Importer.getToContext().getExternalSource())
+    return false;
+
+  // The members of an inline namespace are also visible in the enclosing
+  // namespace, and the layout of a dynamic class depends on all of its
+  // virtual functions.
+  if (FromDC->isInlineNamespace())
+    return false;
+  if (CXXRecordDecl *FromRecord = dyn_cast<CXXRecordDecl>(FromDC))
+    if (FromRecord->isDynamicClass())
+      return false;
+
+  // Import the fields, which make up the layout of a class, and the members
+  // that name lookup can't find.
+  for (auto *From : FromDC->decls()) {
+    NamedDecl *ND = dyn_cast<NamedDecl>(From);
+    if (!ND || !ND->getDeclName() || isa<FieldDecl>(ND) ||
+        isa<IndirectFieldDecl>(ND))
+      Importer.Import(From);
+  }
+
+  Importer.setLazyContext(ToDC, FromDC);
+  return true;
+}
+
 bool ASTNodeImporter::ImportDefinition(RecordDecl *From, RecordDecl *To, 
                                        ImportDefinitionKind Kind) {
   if (To->getDefinition() || To->isBeingDefined()) {
@@ -2197,7 +2268,8 @@ bool ASTNodeImporter::ImportDefinition(RecordDecl *From, RecordDecl *To,
       ToCXX->setBases(Bases.data(), Bases.size());
   }
   
-  if (shouldForceImportDeclContext(Kind))
+  if (shouldForceImportDeclContext(Kind) &&
+      (Kind == IDK_Everything || !ImportDeclContextLazily(From, To)))
     ImportDeclContext(From, /*ForceImport=*/true);
   
   To->completeDefinition();
@@ -2378,6 +2450,7 @@ bool ASTNodeImporter::IsStructuralMatch(RecordDecl *FromRecord,
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    ToRecord->getASTContext(),
                                    Importer.getNonEquivalentDecls(),
+                                   Importer.getEquivalentDecls(),
                                    false, Complain);
   return Ctx.IsStructurallyEquivalent(FromRecord, ToRecord);
 }
@@ -2386,14 +2459,16 @@ bool ASTNodeImporter::IsStructuralMatch(VarDecl *FromVar, VarDecl *ToVar,
                                         bool Complain) {
   StructuralEquivalenceContext Ctx(
       Importer.getFromContext(), Importer.getToContext(),
-      Importer.getNonEquivalentDecls(), false, Complain);
+      Importer.getNonEquivalentDecls(), Importer.getEquivalentDecls(), false,
+      Complain);
   return Ctx.IsStructurallyEquivalent(FromVar, ToVar);
 }
 
 bool ASTNodeImporter::IsStructuralMatch(EnumDecl *FromEnum, EnumDecl *ToEnum) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(FromEnum, ToEnum);
 }
 
@@ -2412,7 +2487,8 @@ bool ASTNodeImporter::IsStructuralMatch(ClassTemplateDecl *From,
                                         ClassTemplateDecl *To) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(From, To);  
 }
 
@@ -2420,7 +2496,8 @@ bool ASTNodeImporter::IsStructuralMatch(VarTemplateDecl *From,
                                         VarTemplateDecl *To) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(From, To);
 }
 
@@ -2530,7 +2607,8 @@ Decl *ASTNodeImporter::VisitNamespaceDecl(NamespaceDecl *D) {
   }
   Importer.Imported(D, ToNamespace);
   
-  ImportDeclContext(D);
+  if (!ImportDeclContextLazily(D, ToNamespace))
+    ImportDeclContext(D);
   
   return ToNamespace;
 }
@@ -6047,7 +6125,7 @@ ASTImporter::ASTImporter(ASTContext &ToContext, FileManager &ToFileManager,
                          bool MinimalImport)
   : ToContext(ToContext), FromContext(FromContext),
     ToFileManager(ToFileManager), FromFileManager(FromFileManager),
-    Minimal(MinimalImport), LastDiagFromFrom(false)
+    Minimal(MinimalImport), LazyMembers(false), LastDiagFromFrom(false)
 {
   ImportedDecls[FromContext.getTranslationUnitDecl()]
     = ToContext.getTranslationUnitDecl();
@@ -6695,6 +6773,12 @@ Decl *ASTImporter::Imported(Decl *From, Decl *To) {
   return To;
 }
 
+void ASTImporter::setLazyContext(DeclContext *ToDC, DeclContext *FromDC) {
+  ToDC = ToDC->getPrimaryContext();
+  LazyContexts[ToDC] = FromDC->getPrimaryContext();
+  ToDC->setHasExternalVisibleStorage(true);
+}
+
 bool ASTImporter::IsStructurallyEquivalent(QualType From, QualType To,
                                            bool Complain) {
   llvm::DenseMap<const Type *, const Type *>::iterator Pos
@@ -6703,6 +6787,149 @@ bool ASTImporter::IsStructurallyEquivalent(QualType From, QualType To,
     return true;
       
   StructuralEquivalenceContext Ctx(FromContext, ToContext, NonEquivalentDecls,
-                                   false, Complain);
+                                   EquivalentDecls, false, Complain);
   return Ctx.IsStructurallyEquivalent(From, To);
 }
+
+//----------------------------------------------------------------------------
+// Lazy member import
+//----------------------------------------------------------------------------
+
+/// \brief Find the declarations in \p FromDC which import as declarations
+/// named \p Name.
+static void findOriginalDecls(ASTImporter &Importer, DeclContext *FromDC,
+                              DeclarationName Name,
+                              SmallVectorImpl<NamedDecl *> &FromDecls) {
+  ASTContext &FromCtx = Importer.getFromContext();
+  DeclarationNameTable &Names = FromCtx.DeclarationNames;
+  DeclarationName FromName;
+  switch (Name.getNameKind()) {
+  case DeclarationName::Identifier:
+    if (IdentifierInfo *II = Name.getAsIdentifierInfo())
+      FromName = &FromCtx.Idents.get(II->getName());
+    break;
+
+  case DeclarationName::ObjCZeroArgSelector:
+  case DeclarationName::ObjCOneArgSelector:
+  case DeclarationName::ObjCMultiArgSelector:
+    // Objective-C containers are always imported eagerly.
+    return;
+
+  case DeclarationName::CXXConstructorName:
+  case DeclarationName::CXXDestructorName: {
+    // Only the class itself declares its constructors and destructor.
+    CXXRecordDecl *FromRecord = dyn_cast<CXXRecordDecl>(FromDC);
+    if (!FromRecord)
+      return;
+    CanQualType T =
+        FromCtx.getCanonicalType(FromCtx.getTypeDeclType(FromRecord));
+    if (Name.getNameKind() == DeclarationName::CXXConstructorName)
+      FromName = Names.getCXXConstructorName(T);
+    else
+      FromName = Names.getCXXDestructorName(T);
+    break;
+  }
+
+  case DeclarationName::CXXConversionFunctionName: {
+    // The type converted to may be spelled differently in the "from" context,
+    // so compare the imported names of all conversion functions.
+    SmallVector<DeclarationName, 4> Conversions;
+    for (auto I = FromDC->lookups_begin(), E = FromDC->lookups_end(); I != E;
+         ++I)
+      if (I.getLookupName().getNameKind() ==
+          DeclarationName::CXXConversionFunctionName)
+        Conversions.push_back(I.getLookupName());
+    for (DeclarationName Conversion : Conversions) {
+      if (Importer.Import(Conversion) != Name)
+        continue;
+      DeclContext::lookup_result R = FromDC->lookup(Conversion);
+      FromDecls.append(R.begin(), R.end());
+    }
+    return;
+  }
+
+  case DeclarationName::CXXOperatorName:
+    FromName = Names.getCXXOperatorName(Name.getCXXOverloadedOperator());
+    break;
+
+  case DeclarationName::CXXLiteralOperatorName:
+    FromName = Names.getCXXLiteralOperatorName(
+        &FromCtx.Idents.get(Name.getCXXLiteralIdentifier()->getName()));
+    break;
+
+  case DeclarationName::CXXUsingDirective:
+    FromName = DeclarationName::getUsingDirectiveName();
+    break;
+  }
+
+  if (!FromName)
+    return;
+  DeclContext::lookup_result R = FromDC->lookup(FromName);
+  FromDecls.append(R.begin(), R.end());
+}
+
+bool ASTImporterLookupSource::FindExternalVisibleDeclsByName(
+    const DeclContext *DC, DeclarationName Name) {
+  std::pair<const DeclContext *, DeclarationName> Lookup(DC, Name);
+  if (std::find(ActiveLookups.begin(), ActiveLookups.end(), Lookup) !=
+      ActiveLookups.end())
+    return false;
+
+  ActiveLookups.push_back(Lookup);
+  bool IsLazyContext = false;
+  SmallVector<NamedDecl *, 4> Decls;
+  for (ASTImporter *Importer : Importers) {
+    DeclContext *FromDC = Importer->getLazyContextOrigin(DC);
+    if (!FromDC)
+      continue;
+    IsLazyContext = true;
+
+    SmallVector<NamedDecl *, 4> FromDecls;
+    findOriginalDecls(*Importer, FromDC, Name, FromDecls);
+    for (NamedDecl *FromD : FromDecls) {
+      // The declaration may have been merged into one we already have, or
+      // renamed or moved while being imported.
+      NamedDecl *ToD = dyn_cast_or_null<NamedDecl>(Importer->Import(FromD));
+      if (ToD && ToD->getDeclName() == Name &&
+          ToD->getDeclContext()->getRedeclContext()->Equals(DC) &&
+          std::find(Decls.begin(), Decls.end(), ToD) == Decls.end())
+        Decls.push_back(ToD);
+    }
+  }
+  ActiveLookups.pop_back();
+
+  if (!IsLazyContext)
+    return false;
+
+  if (Decls.empty()) {
+    SetNoExternalVisibleDeclsForName(DC, Name);
+    return false;
+  }
+
+  ++NumLookups;
+  NumDeclsImported += Decls.size();
+  SetExternalVisibleDeclsForName(DC, Name, Decls);
+  return true;
+}
+
+void ASTImporterLookupSource::completeVisibleDeclsMap(const DeclContext *DC) {
+  for (ASTImporter *Importer : Importers) {
+    DeclContext *FromDC = Importer->getLazyContextOrigin(DC);
+    if (!FromDC)
+      continue;
+
+    SmallVector<DeclarationName, 16> FromNames;
+    for (auto I = FromDC->lookups_begin(), E = FromDC->lookups_end(); I != E;
+         ++I)
+      FromNames.push_back(I.getLookupName());
+    for (DeclarationName FromName : FromNames)
+      if (DeclarationName Name = Importer->Import(FromName))
+        FindExternalVisibleDeclsByName(DC, Name);
+  }
+}
+
+void ASTImporterLookupSource::PrintStats() {
+  llvm::errs() << "*** AST Importer Lookup Statistics:\n"
+               << "  " << NumLookups << " lookups imported "
+               << NumDeclsImported << " declarations\n";
+}
@@ -1738,6 +1738,21 @@ void StoredDeclsMap::DestroyAll(StoredDeclsMap *Map, bool Dependent) {
   }
 }
 
+void StoredDeclsMap::buildIndex() {
+  Index.reset(new llvm::DenseMap<DeclarationName, unsigned>(size() * 2));
+  for (unsigned I = 0, E = size(); I != E; ++I)
+    Index->insert(std::make_pair(Entries[I].first, I));
+}
+
+size_t StoredDeclsMap::getMemorySize() const {
+  size_t Size = sizeof(*this);
+  if (Entries.capacity() > NumInlineEntries)
+    Size += Entries.capacity() * sizeof(value_type);
+  if (Index)
+    Size += sizeof(*Index) + Index->getMemorySize();
+  return Size;
+}
+
 DependentDiagnostic *DependentDiagnostic::Create(ASTContext &C,
                                                  DeclContext *Parent,
                                            const PartialDiagnostic &PDiag) {
@@ -15,7 +15,10 @@
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MathExtras.h"
+#include <cstdio>
 using namespace clang;
 
 static const Builtin::Info BuiltinInfo[] = {
@@ -86,6 +89,10 @@ void Builtin::Context::initializeBuiltins(IdentifierTable &Table,
       Table.get(BuiltinInfo[i].Name).setBuiltinID(i);
     }
 
+  // Target-specific builtins are marked as their identifiers are created.
+  if (Table.getLazyBuiltins() == this)
+    return;
+
   // Step #2: Register target-specific builtins.
   for (unsigned i = 0, e = TSRecords.size(); i != e; ++i)
     if (builtinIsSupported(TSRecords[i], LangOpts))
@@ -97,6 +104,62 @@ void Builtin::Context::initializeBuiltins(IdentifierTable &Table,
         .setBuiltinID(i + Builtin::FirstTSBuiltin + TSRecords.size());
 }
 
+void Builtin::Context::enableLazyTargetBuiltins(IdentifierTable &Table,
+                                                const LangOptions &LangOpts) {
+  LazyLangOpts = &LangOpts;
+  Table.setLazyBuiltins(this);
+}
+
+unsigned Builtin::Context::lookupTargetBuiltin(StringRef Name) {
+  assert(LazyLangOpts && "Lazy target builtins not enabled");
+  ++NumLazyLookups;
+
+  unsigned NumRecords = TSRecords.size() + AuxTSRecords.size();
+  if (NumRecords == 0)
+    return 0;
+
+  if (LazyIndex.empty()) {
+    // Keep the table at most half full so that probe sequences stay short.
+    LazyIndex.resize(llvm::NextPowerOf2(NumRecords * 2));
+    unsigned Mask = LazyIndex.size() - 1;
+    for (unsigned I = 0; I != NumRecords; ++I) {
+      unsigned Slot = llvm::HashString(getName(I + Builtin::FirstTSBuiltin));
+      for (Slot &= Mask; LazyIndex[Slot]; Slot = (Slot + 1) & Mask)
+        ;
+      LazyIndex[Slot] = I + 1;
+    }
+  }
+
+  // Mirror the eager registration order: a later record with the same name
+  // wins, and builtins of the auxiliary target are not filtered.
+  unsigned Mask = LazyIndex.size() - 1;
+  unsigned Best = 0;
+  for (unsigned Slot = llvm::HashString(Name) & Mask; LazyIndex[Slot];
+       Slot = (Slot + 1) & Mask) {
+    unsigned Index = LazyIndex[Slot];
+    if (Index <= Best)
+      continue;
+    const Info &Record = getRecord(Index - 1 + Builtin::FirstTSBuiltin);
+    if (Name != Record.Name)
+      continue;
+    if (Index > TSRecords.size() || builtinIsSupported(Record, *LazyLangOpts))
+      Best = Index;
+  }
+
+  if (!Best)
+    return 0;
+  ++NumLazyBuiltins;
+  return Best - 1 + Builtin::FirstTSBuiltin;
+}
+
+void Builtin::Context::PrintStats() const {
+  fprintf(stderr, "\n*** Builtin Stats:\n");
+  fprintf(stderr, "# Target builtins:        %zu\n",
+          TSRecords.size() + AuxTSRecords.size());
+  fprintf(stderr, "# Lazy lookups:           %u\n", NumLazyLookups);
+  fprintf(stderr, "# Lazily marked builtins: %u\n", NumLazyBuiltins);
+}
+
 void Builtin::Context::forgetBuiltin(unsigned ID, IdentifierTable &Table) {
   Table.get(getRecord(ID).Name).setBuiltinID(0);
 }
@@ -19,7 +19,9 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Locale.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
@@ -73,6 +75,7 @@ DiagnosticsEngine::DiagnosticsEngine(IntrusiveRefCntPtr<DiagnosticIDs> diags,
   FatalsAsError = false;
   SuppressSystemWarnings = false;
   SuppressAllDiagnostics = false;
+  SuppressDuplicates = false;
   ElideType = true;
   PrintTemplateTree = false;
   ShowColors = false;
@@ -83,6 +86,12 @@ DiagnosticsEngine::DiagnosticsEngine(IntrusiveRefCntPtr<DiagnosticIDs> diags,
   TemplateBacktraceLimit = 0;
   ConstexprBacktraceLimit = 0;
 
+  HasFormattedCurDiag = false;
+  CollectStats = false;
+  NumFormattedMessages = NumReusedMessages = 0;
+  NumDroppedNotes = 0;
+  FormattingTime = 0;
+
   Reset();
 }
 
@@ -122,6 +131,8 @@ void DiagnosticsEngine::Reset() {
   
   NumWarnings = 0;
   NumErrors = 0;
+  GroupCounts.clear();
+  EmittedDiagnostics.clear();
   TrapNumErrorsOccurred = 0;
   TrapNumUnrecoverableErrorsOccurred = 0;
   
@@ -140,6 +151,16 @@ void DiagnosticsEngine::Reset() {
   DiagStatePoints.push_back(DiagStatePoint(&DiagStates.back(), FullSourceLoc()));
 }
 
+void DiagnosticsEngine::PrintStats() const {
+  llvm::errs() << "\n*** Diagnostic Stats:\n";
+  llvm::errs() << NumFormattedMessages << " messages formatted, "
+               << NumReusedMessages << " reused by other consumers, in "
+               << llvm::format("%.4f", FormattingTime)
+               << " seconds.\n";
+  llvm::errs() << NumDroppedNotes
+               << " notes dropped because no consumer needs them.\n";
+}
+
 void DiagnosticsEngine::SetDelayedDiagnostic(unsigned DiagID, StringRef Arg1,
                                              StringRef Arg2) {
   if (DelayedDiagID)
@@ -636,10 +657,34 @@ FormatDiagnostic(SmallVectorImpl<char> &OutStr) const {
     return;
   }
 
+  // Several consumers may be chained to the engine; only the first one to ask
+  // for the message pays for rendering types, template diffs and the like.
+  if (DiagObj->HasFormattedCurDiag) {
+    ++DiagObj->NumReusedMessages;
+    OutStr.append(DiagObj->FormattedCurDiag.begin(),
+                  DiagObj->FormattedCurDiag.end());
+    return;
+  }
+
+  llvm::TimeRecord StartTime;
+  if (DiagObj->CollectStats)
+    StartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+
   StringRef Diag = 
     getDiags()->getDiagnosticIDs()->getDescription(getID());
 
-  FormatDiagnostic(Diag.begin(), Diag.end(), OutStr);
+  SmallString<128> &Message = DiagObj->FormattedCurDiag;
+  Message.clear();
+  FormatDiagnostic(Diag.begin(), Diag.end(), Message);
+  DiagObj->HasFormattedCurDiag = true;
+  ++DiagObj->NumFormattedMessages;
+  OutStr.append(Message.begin(), Message.end());
+
+  if (DiagObj->CollectStats) {
+    llvm::TimeRecord Elapsed = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+    Elapsed -= StartTime;
+    DiagObj->FormattingTime += Elapsed.getProcessTime();
+  }
 }
 
 void Diagnostic::
@@ -1001,6 +1046,10 @@ bool ForwardingDiagnosticConsumer::IncludeInDiagnosticCounts() const {
   return Target.IncludeInDiagnosticCounts();
 }
 
+bool ForwardingDiagnosticConsumer::needsNotes() const {
+  return Target.needsNotes();
+}
+
 PartialDiagnostic::StorageAllocator::StorageAllocator() {
   for (unsigned I = 0; I != NumCached; ++I)
     FreeList[I] = Cached + I;
@@ -16,8 +16,10 @@
 #include "clang/Basic/DiagnosticCategories.h"
 #include "clang/Basic/SourceManager.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
 #include <map>
 using namespace clang;
 
@@ -599,6 +601,30 @@ StringRef DiagnosticIDs::getNearestOption(diag::Flavor Flavor,
   return Best;
 }
 
+/// \brief Build the identity of a diagnostic for recognizing duplicates: its
+/// ID, location and arguments.
+static void getDiagnosticKey(const Diagnostic &Info,
+                             SmallVectorImpl<char> &Key) {
+  llvm::raw_svector_ostream OS(Key);
+  OS << Info.getID() << ':' << Info.getLocation().getRawEncoding();
+  for (unsigned I = 0, E = Info.getNumArgs(); I != E; ++I) {
+    DiagnosticsEngine::ArgumentKind Kind = Info.getArgKind(I);
+    OS << ':' << unsigned(Kind) << '=';
+    // Strings are prefixed by their length, so that they can contain ':'.
+    if (Kind == DiagnosticsEngine::ak_std_string) {
+      const std::string &Str = Info.getArgStdStr(I);
+      OS << Str.size() << '"' << Str;
+    } else if (Kind == DiagnosticsEngine::ak_c_string) {
+      StringRef Str = Info.getArgCStr(I);
+      OS << Str.size() << '"' << Str;
+    } else {
+      // Types, declarations and the like are unique within the compilation,
+      // so their opaque values identify them.
+      OS << Info.getRawArg(I);
+    }
+  }
+}
+
 /// ProcessDiag - This is the method used to report a diagnostic that is
 /// finally fully formed.
 bool DiagnosticIDs::ProcessDiag(DiagnosticsEngine &Diag) const {
@@ -622,6 +648,11 @@ bool DiagnosticIDs::ProcessDiag(DiagnosticsEngine &Diag) const {
   if (Diag.SuppressAllDiagnostics)
     return false;
 
+  if (DiagLevel == DiagnosticIDs::Note && !Diag.Client->needsNotes()) {
+    ++Diag.NumDroppedNotes;
+    return false;
+  }
+
   if (DiagLevel != DiagnosticIDs::Note) {
     // Record that a fatal error occurred only when we see a second
     // non-note diagnostic. This allows notes to be attached to the
@@ -660,6 +691,32 @@ bool DiagnosticIDs::ProcessDiag(DiagnosticsEngine &Diag) const {
       Diag.UncompilableErrorOccurred = true;
 
     Diag.ErrorOccurred = true;
+  }
+
+  if (DiagLevel != DiagnosticIDs::Note) {
+    bool IsDuplicate = false;
+    if (Diag.SuppressDuplicates && DiagLevel != DiagnosticIDs::Fatal) {
+      SmallString<64> Key;
+      getDiagnosticKey(Info, Key);
+      IsDuplicate = !Diag.EmittedDiagnostics.insert(Key).second;
+    }
+
+    // Only warnings and errors are counted per group, not remarks.
+    if (DiagLevel >= DiagnosticIDs::Warning) {
+      DiagnosticsEngine::GroupCount &Count =
+          Diag.GroupCounts[getWarningOptionForDiag(DiagID)];
+      ++(IsDuplicate ? Count.Duplicates : Count.Reported);
+    }
+
+    // Drop a repeated diagnostic, and the notes that follow it, before any
+    // client spends time formatting it.
+    if (IsDuplicate) {
+      Diag.LastDiagLevel = DiagnosticIDs::Ignored;
+      return false;
+    }
+  }
+
+  if (DiagLevel >= DiagnosticIDs::Error) {
     if (Diag.Client->IncludeInDiagnosticCounts()) {
       ++Diag.NumErrors;
     }
@@ -500,6 +500,39 @@ void FileManager::invalidateCache(const FileEntry *Entry) {
   UniqueRealFiles.erase(Entry->getUniqueID());
 }
 
+bool FileManager::isCacheUpToDate() {
+  // Virtual files are specific to the compilation that created them.
+  if (!VirtualFileEntries.empty() || !VirtualDirectoryEntries.empty())
+    return false;
+
+  vfs::Status Status;
+  for (const auto &Dir : SeenDirEntries) {
+    if (!Dir.getValue())
+      continue;
+    bool Exists = !getNoncachedStatValue(Dir.getKey(), Status);
+    if (Exists != (Dir.getValue() != NON_EXISTENT_DIR))
+      return false;
+  }
+
+  for (const auto &File : SeenFileEntries) {
+    const FileEntry *Entry = File.getValue();
+    if (!Entry)
+      continue;
+    bool Exists = !getNoncachedStatValue(File.getKey(), Status);
+    if (Entry == NON_EXISTENT_FILE) {
+      if (Exists)
+        return false;
+      continue;
+    }
+    if (!Exists || Status.getUniqueID() != Entry->getUniqueID() ||
+        (off_t)Status.getSize() != Entry->getSize() ||
+        Status.getLastModificationTime().toEpochTime() !=
+            Entry->getModificationTime())
+      return false;
+  }
+  return true;
+}
+
 void FileManager::GetUniqueIDMapping(
                    SmallVectorImpl<const FileEntry *> &UIDToFiles) const {
   UIDToFiles.clear();
@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/Basic/Builtins.h"
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/LangOptions.h"
@@ -75,7 +76,7 @@ IdentifierIterator *IdentifierInfoLookup::getIdentifiers() {
 IdentifierTable::IdentifierTable(const LangOptions &LangOpts,
                                  IdentifierInfoLookup* externalLookup)
   : HashTable(8192), // Start with space for 8K identifiers.
-    ExternalLookup(externalLookup) {
+    ExternalLookup(externalLookup), LazyBuiltins(nullptr) {
 
   // Populate the identifier table with info about keywords for the current
   // language.
@@ -305,6 +306,21 @@ tok::PPKeywordKind IdentifierInfo::getPPKeywordID() const {
   }
 }
 
+void IdentifierTable::setLazyBuiltins(Builtin::Context *Builtins) {
+  LazyBuiltins = Builtins;
+  if (!LazyBuiltins)
+    return;
+
+  for (auto &Entry : HashTable)
+    if (Entry.getValue() && Entry.getKey().startswith("_"))
+      markLazyBuiltin(*Entry.getValue());
+}
+
+void IdentifierTable::markLazyBuiltin(IdentifierInfo &II) {
+  if (unsigned ID = LazyBuiltins->lookupTargetBuiltin(II.getName()))
+    II.setBuiltinID(ID);
+}
+
 //===----------------------------------------------------------------------===//
 // Stats Implementation
 //===----------------------------------------------------------------------===//
@@ -338,6 +354,9 @@ void IdentifierTable::PrintStats() const {
 
   // Compute statistics about the memory allocated for identifiers.
   HashTable.getAllocator().PrintStats();
+
+  if (LazyBuiltins)
+    LazyBuiltins->PrintStats();
 }
 
 //===----------------------------------------------------------------------===//
@@ -362,7 +362,9 @@ SourceManager::SourceManager(DiagnosticsEngine &Diag, FileManager &FileMgr,
   : Diag(Diag), FileMgr(FileMgr), OverridenFilesKeepOriginalName(true),
     UserFilesAreVolatile(UserFilesAreVolatile), FilesAreTransient(false),
     ExternalSLocEntries(nullptr), LineTable(nullptr), NumLinearScans(0),
-    NumBinaryProbes(0) {
+    NumBinaryProbes(0), NumLookasideHits(0), NumPrecomputedLineTables(0),
+    NumExpansionEntries(0), NumMergedMacroArgExpansions(0),
+    ExpansionAddrSpaceUsed(0) {
   clearIDTables();
   Diag.setSourceManager(this);
 }
@@ -395,9 +397,15 @@ void SourceManager::clearIDTables() {
   LocalSLocEntryTable.clear();
   LoadedSLocEntryTable.clear();
   SLocEntryLoaded.clear();
+  LoadedSLocEntryOffsets.clear();
+  LocalIncludeTree.clear();
+  LoadedIncludeTree.clear();
   LastLineNoFileIDQuery = FileID();
   LastLineNoContentCache = nullptr;
   LastFileIDLookup = FileID();
+  for (FileID &FID : FileIDLookaside)
+    FID = FileID();
+  NextFileIDLookaside = 0;
 
   if (LineTable)
     LineTable->clear();
@@ -472,6 +480,7 @@ const SrcMgr::SLocEntry &SourceManager::loadSLocEntry(unsigned Index,
     }
   }
 
+  LoadedSLocEntryOffsets[Index] = LoadedSLocEntryTable[Index].getOffset();
   return LoadedSLocEntryTable[Index];
 }
 
@@ -484,6 +493,7 @@ SourceManager::AllocateLoadedSLocEntries(unsigned NumSLocEntries,
     return std::make_pair(0, 0);
   LoadedSLocEntryTable.resize(LoadedSLocEntryTable.size() + NumSLocEntries);
   SLocEntryLoaded.resize(LoadedSLocEntryTable.size());
+  LoadedSLocEntryOffsets.resize(LoadedSLocEntryTable.size());
   CurrentLoadedOffset -= TotalSize;
   int ID = LoadedSLocEntryTable.size();
   return std::make_pair(-ID - 1, CurrentLoadedOffset);
@@ -567,6 +577,7 @@ FileID SourceManager::createFileID(const ContentCache *File,
     LoadedSLocEntryTable[Index] = SLocEntry::get(LoadedOffset,
         FileInfo::get(IncludePos, File, FileCharacter));
     SLocEntryLoaded[Index] = true;
+    LoadedSLocEntryOffsets[Index] = LoadedOffset;
     return FileID::get(LoadedID);
   }
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset,
@@ -592,9 +603,61 @@ SourceManager::createMacroArgExpansionLoc(SourceLocation SpellingLoc,
                                           unsigned TokLength) {
   ExpansionInfo Info = ExpansionInfo::createForMacroArg(SpellingLoc,
                                                         ExpansionLoc);
+  SourceLocation Extended = extendMacroArgExpansionLoc(Info, TokLength);
+  if (Extended.isValid())
+    return Extended;
   return createExpansionLocImpl(Info, TokLength);
 }
 
+SourceLocation
+SourceManager::extendMacroArgExpansionLoc(const ExpansionInfo &Info,
+                                          unsigned TokLength) {
+  if (LocalSLocEntryTable.empty())
+    return SourceLocation();
+  const SLocEntry &Last = LocalSLocEntryTable.back();
+  if (!Last.isExpansion())
+    return SourceLocation();
+  const ExpansionInfo &LastInfo = Last.getExpansion();
+  if (!LastInfo.isMacroArgExpansion() ||
+      LastInfo.getExpansionLocStart() != Info.getExpansionLocStart())
+    return SourceLocation();
+
+  // Group together tokens whose spellings are close, even if they point to
+  // different FileIDs, e.g. for
+  //
+  //  |bar    |  foo | cake   |  (3 tokens from 3 consecutive FileIDs)
+  //  ^                    ^
+  //  |bar       foo   cake|     (one SLocEntry chunk for all tokens)
+  //
+  // This works since a token's spelling location only depends on its offset
+  // from the start of the entry. Tokens spelled in a macro expansion have to
+  // come from the same one.
+  SourceLocation LastSpelling = LastInfo.getSpellingLoc();
+  SourceLocation Spelling = Info.getSpellingLoc();
+  int RelOffs;
+  if (LastSpelling.isFileID() != Spelling.isFileID() ||
+      !isInSameSLocAddrSpace(LastSpelling, Spelling, &RelOffs))
+    return SourceLocation();
+  if (Spelling.isMacroID() && getFileID(LastSpelling) != getFileID(Spelling))
+    return SourceLocation();
+
+  // The token has to follow what the entry already covers, at most 50
+  // "characters" away.
+  unsigned EntrySize = NextLocalOffset - Last.getOffset() - 1;
+  if (RelOffs < 0 || unsigned(RelOffs) < EntrySize ||
+      unsigned(RelOffs) > EntrySize + 50)
+    return SourceLocation();
+
+  unsigned NewEnd = Last.getOffset() + RelOffs + TokLength + 1;
+  if (NewEnd > NextLocalOffset) {
+    assert(NewEnd <= CurrentLoadedOffset && "Ran out of source locations!");
+    ExpansionAddrSpaceUsed += NewEnd - NextLocalOffset;
+    NextLocalOffset = NewEnd;
+  }
+  ++NumMergedMacroArgExpansions;
+  return SourceLocation::getMacroLoc(Last.getOffset() + RelOffs);
+}
+
 SourceLocation
 SourceManager::createExpansionLoc(SourceLocation SpellingLoc,
                                   SourceLocation ExpansionLocStart,
@@ -619,12 +682,15 @@ SourceManager::createExpansionLocImpl(const ExpansionInfo &Info,
     assert(!SLocEntryLoaded[Index] && "FileID already loaded");
     LoadedSLocEntryTable[Index] = SLocEntry::get(LoadedOffset, Info);
     SLocEntryLoaded[Index] = true;
+    LoadedSLocEntryOffsets[Index] = LoadedOffset;
     return SourceLocation::getMacroLoc(LoadedOffset);
   }
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset, Info));
   assert(NextLocalOffset + TokLength + 1 > NextLocalOffset &&
          NextLocalOffset + TokLength + 1 <= CurrentLoadedOffset &&
          "Ran out of source locations!");
+  ++NumExpansionEntries;
+  ExpansionAddrSpaceUsed += TokLength + 1;
   // See createFileID for that +1.
   NextLocalOffset += TokLength + 1;
   return SourceLocation::getMacroLoc(NextLocalOffset - (TokLength + 1));
@@ -711,11 +777,29 @@ FileID SourceManager::getFileIDSlow(unsigned SLocOffset) const {
   if (!SLocOffset)
     return FileID::get(0);
 
+  // getFileID has already checked LastFileIDLookup, so only now check the
+  // files that were in LastFileIDLookup before it. On a hit, swap the two so
+  // that the file we are leaving stays in the lookaside.
+  FileID PrevFileIDLookup = LastFileIDLookup;
+  for (FileID &FID : FileIDLookaside) {
+    if (FID.isValid() && isOffsetInFileID(FID, SLocOffset)) {
+      ++NumLookasideHits;
+      std::swap(FID, LastFileIDLookup);
+      return LastFileIDLookup;
+    }
+  }
+
   // Now it is time to search for the correct file. See where the SLocOffset
   // sits in the global view and consult local or loaded buffers for it.
-  if (SLocOffset < NextLocalOffset)
-    return getFileIDLocal(SLocOffset);
-  return getFileIDLoaded(SLocOffset);
+  FileID Res = SLocOffset < NextLocalOffset ? getFileIDLocal(SLocOffset)
+                                            : getFileIDLoaded(SLocOffset);
+
+  // If the search replaced LastFileIDLookup, keep the file it replaced.
+  if (PrevFileIDLookup.isValid() && LastFileIDLookup != PrevFileIDLookup) {
+    FileIDLookaside[NextFileIDLookaside] = PrevFileIDLookup;
+    NextFileIDLookaside = (NextFileIDLookaside + 1) % FileIDLookasideSize;
+  }
+  return Res;
 }
 
 /// \brief Return the FileID for a SourceLocation with a low offset.
@@ -824,24 +908,28 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
   // in the other direction.
 
   // First do a linear scan from the last lookup position, if possible.
+  // Only the offsets of the entries are needed for the search, and they are
+  // usually known without loading the entries. Load the result, though, to
+  // see whether it should be cached.
+  auto foundLoadedEntry = [&](unsigned Index) {
+    FileID Res = FileID::get(-int(Index) - 2);
+    if (!getLoadedSLocEntry(Index).isExpansion())
+      LastFileIDLookup = Res;
+    return Res;
+  };
+
   unsigned I;
   int LastID = LastFileIDLookup.ID;
-  if (LastID >= 0 || getLoadedSLocEntryByID(LastID).getOffset() < SLocOffset)
+  if (LastID >= 0 || getLoadedSLocEntryOffset(-LastID - 2) < SLocOffset)
     I = 0;
   else
     I = (-LastID - 2) + 1;
 
   unsigned NumProbes;
   for (NumProbes = 0; NumProbes < 8; ++NumProbes, ++I) {
-    // Make sure the entry is loaded!
-    const SrcMgr::SLocEntry &E = getLoadedSLocEntry(I);
-    if (E.getOffset() <= SLocOffset) {
-      FileID Res = FileID::get(-int(I) - 2);
-
-      if (!E.isExpansion())
-        LastFileIDLookup = Res;
+    if (getLoadedSLocEntryOffset(I) <= SLocOffset) {
       NumLinearScans += NumProbes + 1;
-      return Res;
+      return foundLoadedEntry(I);
     }
   }
 
@@ -854,13 +942,13 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
   while (1) {
     ++NumProbes;
     unsigned MiddleIndex = (LessIndex - GreaterIndex) / 2 + GreaterIndex;
-    const SrcMgr::SLocEntry &E = getLoadedSLocEntry(MiddleIndex);
-    if (E.getOffset() == 0)
+    unsigned MiddleOffset = getLoadedSLocEntryOffset(MiddleIndex);
+    if (MiddleOffset == 0)
       return FileID(); // invalid entry.
 
     ++NumProbes;
 
-    if (E.getOffset() > SLocOffset) {
+    if (MiddleOffset > SLocOffset) {
       // Sanity checking, otherwise a bug may lead to hanging in release build.
       if (GreaterIndex == MiddleIndex) {
         assert(0 && "binary search missed the entry");
@@ -871,11 +959,8 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
     }
 
     if (isOffsetInFileID(FileID::get(-int(MiddleIndex) - 2), SLocOffset)) {
-      FileID Res = FileID::get(-int(MiddleIndex) - 2);
-      if (!E.isExpansion())
-        LastFileIDLookup = Res;
       NumBinaryProbes += NumProbes;
-      return Res;
+      return foundLoadedEntry(MiddleIndex);
     }
 
     // Sanity checking, otherwise a bug may lead to hanging in release build.
@@ -1212,68 +1297,46 @@ static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
   LineOffsets.push_back(0);
 
   const unsigned char *Buf = (const unsigned char *)Buffer->getBufferStart();
-  const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
-  unsigned Offs = 0;
-  while (1) {
-    // Skip over the contents of the line.
-    const unsigned char *NextBuf = (const unsigned char *)Buf;
-
-#ifdef __SSE2__
-    // Try to skip to the next newline using SSE instructions. This is very
-    // performance sensitive for programs with lots of diagnostics and in -E
-    // mode.
-    __m128i CRs = _mm_set1_epi8('\r');
-    __m128i LFs = _mm_set1_epi8('\n');
-
-    // First fix up the alignment to 16 bytes.
-    while (((uintptr_t)NextBuf & 0xF) != 0) {
-      if (*NextBuf == '\n' || *NextBuf == '\r' || *NextBuf == '\0')
-        goto FoundSpecialChar;
-      ++NextBuf;
-    }
-
-    // Scan 16 byte chunks for '\r' and '\n'. Ignore '\0'.
-    while (NextBuf+16 <= End) {
-      const __m128i Chunk = *(const __m128i*)NextBuf;
-      __m128i Cmp = _mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
-                                 _mm_cmpeq_epi8(Chunk, LFs));
-      unsigned Mask = _mm_movemask_epi8(Cmp);
-
-      // If we found a newline, adjust the pointer and jump to the handling code.
-      if (Mask != 0) {
-        NextBuf += llvm::countTrailingZeros(Mask);
-        goto FoundSpecialChar;
-      }
-      NextBuf += 16;
-    }
-#endif
+  unsigned Size = Buffer->getBufferSize();
+
+  // Record the line starting after the newline character at \p Pos, and
+  // return the position after it. "\r\n" and "\n\r" end a single line. This
+  // relies on the buffer being null terminated.
+  auto addLineAfter = [&](unsigned Pos) {
+    if ((Buf[Pos + 1] == '\n' || Buf[Pos + 1] == '\r') &&
+        Buf[Pos + 1] != Buf[Pos])
+      ++Pos;
+    LineOffsets.push_back(Pos + 1);
+    return Pos + 1;
+  };
 
-    while (*NextBuf != '\n' && *NextBuf != '\r' && *NextBuf != '\0')
-      ++NextBuf;
+  // Newline characters before this position were handled as the second half
+  // of a pair.
+  unsigned NextPos = 0;
+  unsigned I = 0;
 
 #ifdef __SSE2__
-FoundSpecialChar:
-#endif
-    Offs += NextBuf-Buf;
-    Buf = NextBuf;
-
-    if (Buf[0] == '\n' || Buf[0] == '\r') {
-      // If this is \n\r or \r\n, skip both characters.
-      if ((Buf[1] == '\n' || Buf[1] == '\r') && Buf[0] != Buf[1]) {
-        ++Offs;
-        ++Buf;
-      }
-      ++Offs;
-      ++Buf;
-      LineOffsets.push_back(Offs);
-    } else {
-      // Otherwise, this is a null.  If end of file, exit.
-      if (Buf == End) break;
-      // Otherwise, skip the null.
-      ++Offs;
-      ++Buf;
+  // Find all the '\r' and '\n' in 16 byte chunks at once. This is very
+  // performance sensitive for programs with lots of diagnostics and in -E
+  // mode, and most lines are short, so don't restart the scan for each line.
+  const __m128i CRs = _mm_set1_epi8('\r');
+  const __m128i LFs = _mm_set1_epi8('\n');
+  for (; I + 16 <= Size; I += 16) {
+    const __m128i Chunk = _mm_loadu_si128((const __m128i *)(Buf + I));
+    unsigned Mask = _mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs), _mm_cmpeq_epi8(Chunk, LFs)));
+    while (Mask) {
+      unsigned Pos = I + llvm::countTrailingZeros(Mask);
+      Mask &= Mask - 1;
+      if (Pos >= NextPos)
+        NextPos = addLineAfter(Pos);
     }
   }
+#endif
+
+  for (; I < Size; ++I)
+    if ((Buf[I] == '\n' || Buf[I] == '\r') && I >= NextPos)
+      NextPos = addLineAfter(I);
 
   // Copy the offsets into the FileInfo structure.
   FI->NumLines = LineOffsets.size();
@@ -1281,6 +1344,42 @@ FoundSpecialChar:
   std::copy(LineOffsets.begin(), LineOffsets.end(), FI->SourceLineCache);
 }
 
+ArrayRef<unsigned> SourceManager::getLineOffsets(FileID FID) const {
+  bool Invalid = false;
+  getLineNumber(FID, 0, &Invalid);
+  if (Invalid)
+    return None;
+  const ContentCache *Content = getSLocEntry(FID).getFile().getContentCache();
+  return llvm::makeArrayRef(Content->SourceLineCache, Content->NumLines);
+}
+
+void SourceManager::setPrecomputedLineOffsets(FileID FID,
+                                              ArrayRef<unsigned> LineOffsets) {
+  bool Invalid = false;
+  const SLocEntry &Entry = getSLocEntry(FID, &Invalid);
+  if (Invalid || !Entry.isFile() || LineOffsets.empty() || LineOffsets[0] != 0)
+    return;
+
+  ContentCache *Content =
+      const_cast<ContentCache *>(Entry.getFile().getContentCache());
+  if (!Content || Content->SourceLineCache)
+    return;
+
+  // Don't trust a table that doesn't fit the file; the offsets will be
+  // computed from the buffer when they are needed instead.
+  if (LineOffsets.back() > Content->getSize())
+    return;
+  for (unsigned I = 1, E = LineOffsets.size(); I != E; ++I)
+    if (LineOffsets[I] <= LineOffsets[I - 1])
+      return;
+
+  Content->SourceLineCache =
+      ContentCacheAlloc.Allocate<unsigned>(LineOffsets.size());
+  std::copy(LineOffsets.begin(), LineOffsets.end(), Content->SourceLineCache);
+  Content->NumLines = LineOffsets.size();
+  ++NumPrecomputedLineTables;
+}
+
 /// getLineNumber - Given a SourceLocation, return the spelling line number
 /// for the position indicated.  This requires building and caching a table of
 /// line offsets for the MemoryBuffer, so this is not cheap: use only when
@@ -1956,49 +2055,60 @@ SourceManager::getMacroArgExpandedLocation(SourceLocation Loc) const {
   return Loc;
 }
 
-std::pair<FileID, unsigned>
-SourceManager::getDecomposedIncludedLoc(FileID FID) const {
-  if (FID.isInvalid())
-    return std::make_pair(FileID(), 0);
+SourceManager::IncludeTreeNode
+SourceManager::getIncludeTreeNode(FileID FID) const {
+  auto getNode = [&](FileID ID) -> IncludeTreeNode & {
+    std::vector<IncludeTreeNode> &Table =
+        ID.ID >= 0 ? LocalIncludeTree : LoadedIncludeTree;
+    unsigned Index = ID.ID >= 0 ? ID.ID : -ID.ID - 2;
+    if (Index >= Table.size())
+      Table.resize(Index + 1);
+    return Table[Index];
+  };
 
-  // Uses IncludedLocMap to retrieve/cache the decomposed loc.
+  // Walk up to the first ancestor whose node is known, remembering the
+  // included/expanded in locations on the way.
+  SmallVector<std::pair<FileID, std::pair<FileID, unsigned>>, 8> Unknown;
+  unsigned Depth = 0;
+  for (FileID Cur = FID; Cur.isValid();) {
+    if (unsigned KnownDepth = getNode(Cur).Depth) {
+      Depth = KnownDepth;
+      break;
+    }
 
-  typedef std::pair<FileID, unsigned> DecompTy;
-  typedef llvm::DenseMap<FileID, DecompTy> MapTy;
-  std::pair<MapTy::iterator, bool>
-    InsertOp = IncludedLocMap.insert(std::make_pair(FID, DecompTy()));
-  DecompTy &DecompLoc = InsertOp.first->second;
-  if (!InsertOp.second)
-    return DecompLoc; // already in map.
+    SourceLocation UpperLoc;
+    bool Invalid = false;
+    const SrcMgr::SLocEntry &Entry = getSLocEntry(Cur, &Invalid);
+    if (!Invalid) {
+      if (Entry.isExpansion())
+        UpperLoc = Entry.getExpansion().getExpansionLocStart();
+      else
+        UpperLoc = Entry.getFile().getIncludeLoc();
+    }
 
-  SourceLocation UpperLoc;
-  bool Invalid = false;
-  const SrcMgr::SLocEntry &Entry = getSLocEntry(FID, &Invalid);
-  if (!Invalid) {
-    if (Entry.isExpansion())
-      UpperLoc = Entry.getExpansion().getExpansionLocStart();
-    else
-      UpperLoc = Entry.getFile().getIncludeLoc();
+    std::pair<FileID, unsigned> Parent;
+    if (UpperLoc.isValid())
+      Parent = getDecomposedLoc(UpperLoc);
+    Unknown.push_back(std::make_pair(Cur, Parent));
+    Cur = Parent.first;
   }
 
-  if (UpperLoc.isValid())
-    DecompLoc = getDecomposedLoc(UpperLoc);
+  // Fill in the nodes from the top down.
+  while (!Unknown.empty()) {
+    auto Pending = Unknown.pop_back_val();
+    IncludeTreeNode &Node = getNode(Pending.first);
+    Node.Parent = Pending.second;
+    Node.Depth = ++Depth;
+  }
 
-  return DecompLoc;
+  return getNode(FID);
 }
 
-/// Given a decomposed source location, move it up the include/expansion stack
-/// to the parent source location.  If this is possible, return the decomposed
-/// version of the parent in Loc and return false.  If Loc is the top-level
-/// entry, return true and don't modify it.
-static bool MoveUpIncludeHierarchy(std::pair<FileID, unsigned> &Loc,
-                                   const SourceManager &SM) {
-  std::pair<FileID, unsigned> UpperLoc = SM.getDecomposedIncludedLoc(Loc.first);
-  if (UpperLoc.first.isInvalid())
-    return true; // We reached the top.
-
-  Loc = UpperLoc;
-  return false;
+std::pair<FileID, unsigned>
+SourceManager::getDecomposedIncludedLoc(FileID FID) const {
+  if (FID.isInvalid())
+    return std::make_pair(FileID(), 0);
+  return getIncludeTreeNode(FID).Parent;
 }
 
 /// Return the cache entry for comparing the given file IDs
@@ -2063,25 +2173,19 @@ bool SourceManager::isBeforeInTranslationUnit(SourceLocation LHS,
   IsBeforeInTUCache.setQueryFIDs(LOffs.first, ROffs.first,
                           /*isLFIDBeforeRFID=*/LOffs.first.ID < ROffs.first.ID);
 
-  // We need to find the common ancestor. The only way of doing this is to
-  // build the complete include chain for one and then walking up the chain
-  // of the other looking for a match.
-  // We use a map from FileID to Offset to store the chain. Easier than writing
-  // a custom set hash info that only depends on the first part of a pair.
-  typedef llvm::SmallDenseMap<FileID, unsigned, 16> LocSet;
-  LocSet LChain;
-  do {
-    LChain.insert(LOffs);
-    // We catch the case where LOffs is in a file included by ROffs and
-    // quit early. The other way round unfortunately remains suboptimal.
-  } while (LOffs.first != ROffs.first && !MoveUpIncludeHierarchy(LOffs, *this));
-  LocSet::iterator I;
-  while((I = LChain.find(ROffs.first)) == LChain.end()) {
-    if (MoveUpIncludeHierarchy(ROffs, *this))
-      break; // Met at topmost file.
+  // Find the nearest common ancestor in the include tree: move the deeper
+  // location up to the depth of the other one, then move both up together
+  // until they meet or reach the top.
+  unsigned LDepth = getIncludeTreeNode(LOffs.first).Depth;
+  unsigned RDepth = getIncludeTreeNode(ROffs.first).Depth;
+  for (; LDepth > RDepth; --LDepth)
+    LOffs = getIncludeTreeNode(LOffs.first).Parent;
+  for (; RDepth > LDepth; --RDepth)
+    ROffs = getIncludeTreeNode(ROffs.first).Parent;
+  for (; LOffs.first != ROffs.first && LDepth > 1; --LDepth) {
+    LOffs = getIncludeTreeNode(LOffs.first).Parent;
+    ROffs = getIncludeTreeNode(ROffs.first).Parent;
   }
-  if (I != LChain.end())
-    LOffs = *I;
 
   // If we exited because we found a nearest common ancestor, compare the
   // locations within the common file and cache them.
@@ -2149,10 +2253,17 @@ void SourceManager::PrintStats() const {
   unsigned NumMacroArgsComputed = MacroArgsCacheMap.size();
 
   llvm::errs() << NumFileBytesMapped << " bytes of files mapped, "
-               << NumLineNumsComputed << " files with line #'s computed, "
+               << NumLineNumsComputed << " files with line #'s computed ("
+               << NumPrecomputedLineTables << " loaded from AST files), "
                << NumMacroArgsComputed << " files with macro args computed.\n";
   llvm::errs() << "FileID scans: " << NumLinearScans << " linear, "
-               << NumBinaryProbes << " binary.\n";
+               << NumBinaryProbes << " binary, " << NumLookasideHits
+               << " lookaside hits.\n";
+  llvm::errs() << NumExpansionEntries << " macro expansion SLocEntries created, "
+               << NumMergedMacroArgExpansions
+               << " macro argument expansions merged into the previous one, "
+               << ExpansionAddrSpaceUsed
+               << "B of Sloc address space used by expansions.\n";
 }
 
 LLVM_DUMP_METHOD void SourceManager::dump() const {
@@ -51,6 +51,7 @@ void clang::ProcessWarningOptions(DiagnosticsEngine &Diags,
   Diags.setElideType(Opts.ElideType);
   Diags.setPrintTemplateTree(Opts.ShowTemplateTree);
   Diags.setShowColors(Opts.ShowColors);
+  Diags.setSuppressDuplicateDiagnostics(Opts.SuppressDuplicates);
  
   // Handle -ferror-limit
   if (Opts.ErrorLimit)
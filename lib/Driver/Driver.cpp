@@ -57,7 +57,8 @@ Driver::Driver(StringRef ClangExecutable, StringRef DefaultTargetTriple,
       DriverTitle("clang LLVM compiler"), CCPrintOptionsFilename(nullptr),
       CCPrintHeadersFilename(nullptr), CCLogDiagnosticsFilename(nullptr),
       CCCPrintBindings(false), CCPrintHeaders(false), CCLogDiagnostics(false),
-      CCGenDiagnostics(false), DefaultTargetTriple(DefaultTargetTriple),
+      CCGenDiagnostics(false), CC1Main(nullptr), CC1Server(nullptr),
+      DefaultTargetTriple(DefaultTargetTriple),
       CCCGenericGCCName(""), CheckInputsExist(true), CCCUsePCH(true),
       SuppressMissingInputWarning(false) {
 
@@ -1910,6 +1911,13 @@ void Driver::BuildJobs(Compilation &C) const {
                        /*BuildForOffloadDevice*/ false);
   }
 
+  // Only run -cc1 in-process when it is the sole job; otherwise a crash or a
+  // fatal error in one job would take down the driver and the remaining jobs
+  // with it.
+  if (C.getJobs().size() > 1)
+    for (auto &Job : C.getJobs())
+      Job.setInProcess(false);
+
   // If the user passed -Qunused-arguments or there were errors, don't warn
   // about any unused arguments.
   if (Diags.hasErrorOccurred() ||
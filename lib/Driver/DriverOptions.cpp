@@ -42,3 +42,8 @@ public:
 OptTable *clang::driver::createDriverOptTable() {
   return new DriverOptTable();
 }
+
+const OptTable &clang::driver::getDriverOptTable() {
+  static const DriverOptTable Table;
+  return Table;
+}
@@ -4583,6 +4583,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
 
   Args.AddAllArgs(CmdArgs, options::OPT_v);
   Args.AddLastArg(CmdArgs, options::OPT_H);
+  Args.AddLastArg(CmdArgs, options::OPT_fheader_cost_report,
+                  options::OPT_fheader_cost_report_EQ);
   if (D.CCPrintHeaders && !D.CCGenDiagnostics) {
     CmdArgs.push_back("-header-include-file");
     CmdArgs.push_back(D.CCPrintHeadersFilename ? D.CCPrintHeadersFilename
@@ -5098,6 +5100,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     Args.AddLastArg(CmdArgs, options::OPT_fzvector);
   }
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_show_template_tree);
+  Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_suppress_duplicates);
+  Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_show_group_counts);
   Args.AddLastArg(CmdArgs, options::OPT_fno_elide_type);
 
   // Forward flags for OpenMP. We don't do this if the current action is an
@@ -5565,6 +5569,12 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_use_line_directives, false))
     CmdArgs.push_back("-fuse-line-directives");
 
+  if (const Arg *A =
+          Args.getLastArg(options::OPT_fpreprocessed_chunk_dir_EQ)) {
+    CmdArgs.push_back("-preprocessed-chunk-dir");
+    CmdArgs.push_back(A->getValue());
+  }
+
   // -fms-compatibility=0 is default.
   if (Args.hasFlag(options::OPT_fms_compatibility,
                    options::OPT_fno_ms_compatibility,
@@ -5628,6 +5638,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_delayed_template_parsing, IsWindowsMSVC))
     CmdArgs.push_back("-fdelayed-template-parsing");
 
+  if (Args.hasFlag(options::OPT_fdelayed_inline_method_parsing,
+                   options::OPT_fno_delayed_inline_method_parsing, false))
+    CmdArgs.push_back("-fdelayed-inline-method-parsing");
+
   // -fgnu-keywords default varies depending on language; only pass if
   // specified.
   if (Arg *A = Args.getLastArg(options::OPT_fgnu_keywords,
@@ -5874,6 +5888,17 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  if (const Arg *A = Args.getLastArg(options::OPT_fdiagnostics_json_file_EQ)) {
+    CmdArgs.push_back("-diagnostic-json-file");
+    CmdArgs.push_back(A->getValue());
+  }
+
+  if (const Arg *A =
+          Args.getLastArg(options::OPT_fdiagnostics_sarif_file_EQ)) {
+    CmdArgs.push_back("-diagnostic-sarif-file");
+    CmdArgs.push_back(A->getValue());
+  }
+
   if (Arg *A = Args.getLastArg(
           options::OPT_fdiagnostics_show_note_include_stack,
           options::OPT_fno_diagnostics_show_note_include_stack)) {
@@ -6160,6 +6185,16 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     // fails, so that the main compilation's fallback to cl.exe runs.
     C.addCommand(llvm::make_unique<ForceSuccessCommand>(JA, *this, Exec,
                                                         CmdArgs, Inputs));
+  } else if ((Args.hasFlag(options::OPT_fintegrated_cc1,
+                           options::OPT_fno_integrated_cc1, false) ||
+              D.CC1Server) &&
+             D.CC1Main && !D.CCGenDiagnostics) {
+    auto Cmd = llvm::make_unique<CC1Command>(JA, *this, Exec, CmdArgs, Inputs);
+    // Jobs which the compile server can't take are only run in-process if
+    // that was asked for.
+    Cmd->setInProcess(Args.hasFlag(options::OPT_fintegrated_cc1,
+                                   options::OPT_fno_integrated_cc1, false));
+    C.addCommand(std::move(Cmd));
   } else {
     C.addCommand(llvm::make_unique<Command>(JA, *this, Exec, CmdArgs, Inputs));
   }
@@ -21,6 +21,7 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/JSONDiagnosticPrinter.h"
 #include "clang/Frontend/LogDiagnosticPrinter.h"
 #include "clang/Frontend/SerializedDiagnosticPrinter.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
@@ -188,6 +189,40 @@ static void SetupSerializedDiagnostics(DiagnosticOptions *DiagOpts,
   }
 }
 
+static void SetupJSONDiagnostics(DiagnosticOptions *DiagOpts,
+                                 DiagnosticsEngine &Diags, StringRef OutputFile,
+                                 JSONDiagnosticPrinter::OutputFormat Format) {
+  std::error_code EC;
+  std::unique_ptr<raw_ostream> StreamOwner;
+  raw_ostream *OS = &llvm::errs();
+  if (OutputFile != "-") {
+    // JSON Lines files are shared by parallel compiles, SARIF logs are not.
+    auto FileOS = llvm::make_unique<llvm::raw_fd_ostream>(
+        OutputFile, EC,
+        Format == JSONDiagnosticPrinter::JSON
+            ? llvm::sys::fs::F_Append | llvm::sys::fs::F_Text
+            : llvm::sys::fs::F_Text);
+    if (EC) {
+      Diags.Report(diag::warn_fe_json_diag_failure)
+          << OutputFile << EC.message();
+      return;
+    }
+    FileOS->SetUnbuffered();
+    OS = FileOS.get();
+    StreamOwner = std::move(FileOS);
+  }
+
+  auto Printer = llvm::make_unique<JSONDiagnosticPrinter>(
+      *OS, DiagOpts, Format, std::move(StreamOwner));
+  if (Diags.ownsClient()) {
+    Diags.setClient(
+        new ChainedDiagnosticConsumer(Diags.takeClient(), std::move(Printer)));
+  } else {
+    Diags.setClient(
+        new ChainedDiagnosticConsumer(Diags.getClient(), std::move(Printer)));
+  }
+}
+
 void CompilerInstance::createDiagnostics(DiagnosticConsumer *Client,
                                          bool ShouldOwnClient) {
   Diagnostics = createDiagnostics(&getDiagnosticOpts(), Client,
@@ -221,6 +256,14 @@ CompilerInstance::createDiagnostics(DiagnosticOptions *Opts,
   if (!Opts->DiagnosticSerializationFile.empty())
     SetupSerializedDiagnostics(Opts, *Diags,
                                Opts->DiagnosticSerializationFile);
+
+  if (!Opts->DiagnosticJSONFile.empty())
+    SetupJSONDiagnostics(Opts, *Diags, Opts->DiagnosticJSONFile,
+                         JSONDiagnosticPrinter::JSON);
+
+  if (!Opts->DiagnosticSARIFFile.empty())
+    SetupJSONDiagnostics(Opts, *Diags, Opts->DiagnosticSARIFFile,
+                         JSONDiagnosticPrinter::SARIF);
   
   // Configure our handling of diagnostics.
   ProcessWarningOptions(*Diags, *Opts);
@@ -382,6 +425,12 @@ void CompilerInstance::createPreprocessor(TranslationUnitKind TUKind) {
                            /*ShowAllHeaders=*/true, /*OutputPath=*/"",
                            /*ShowDepth=*/true, /*MSStyle=*/true);
   }
+
+  if (!DepOpts.HeaderCostReportFile.empty()) {
+    HeaderCosts =
+        std::make_shared<HeaderCostCollector>(DepOpts.HeaderCostReportFile);
+    HeaderCosts->attachToPreprocessor(*PP);
+  }
 }
 
 std::string CompilerInstance::getSpecificModuleCachePath() {
@@ -716,6 +765,41 @@ bool CompilerInstance::InitializeSourceManager(const FrontendInputFile &Input){
       getDependencyOutputOpts(), getFrontendOpts());
 }
 
+/// Whether \p Input is preprocessed output which may refer to chunks in
+/// -preprocessed-chunk-dir.
+static bool usesPreprocessedChunks(const FrontendInputFile &Input,
+                                   const FrontendOptions &Opts) {
+  if (Opts.PreprocessedChunkDir.empty())
+    return false;
+  switch (Input.getKind()) {
+  case IK_PreprocessedC:
+  case IK_PreprocessedCXX:
+  case IK_PreprocessedObjC:
+  case IK_PreprocessedObjCXX:
+  case IK_PreprocessedCuda:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Expand the chunk references in \p Buffer, the contents of \p Input.
+static bool
+expandPreprocessedChunks(const FrontendInputFile &Input,
+                         const FrontendOptions &Opts, DiagnosticsEngine &Diags,
+                         std::unique_ptr<llvm::MemoryBuffer> &Buffer) {
+  if (!usesPreprocessedChunks(Input, Opts))
+    return true;
+
+  std::unique_ptr<llvm::MemoryBuffer> Expanded;
+  if (!ExpandPreprocessedChunks(*Buffer, Opts.PreprocessedChunkDir, Diags,
+                                Expanded))
+    return false;
+  if (Expanded)
+    Buffer = std::move(Expanded);
+  return true;
+}
+
 // static
 bool CompilerInstance::InitializeSourceManager(
     const FrontendInputFile &Input, DiagnosticsEngine &Diags,
@@ -777,6 +861,8 @@ bool CompilerInstance::InitializeSourceManager(
     // STDIN.
     if (File->isNamedPipe()) {
       auto MB = FileMgr.getBufferForFile(File, /*isVolatile=*/true);
+      if (MB && !expandPreprocessedChunks(Input, Opts, Diags, *MB))
+        return false;
       if (MB) {
         // Create a new virtual file that will have the correct size.
         File = FileMgr.getVirtualFile(InputFile, (*MB)->getBufferSize(), 0);
@@ -786,6 +872,18 @@ bool CompilerInstance::InitializeSourceManager(
                                                  << MB.getError().message();
         return false;
       }
+    } else if (usesPreprocessedChunks(Input, Opts)) {
+      // Read the file now to expand its chunk references, and keep what was
+      // read so that it isn't read again.
+      auto MB = FileMgr.getBufferForFile(File);
+      if (!MB) {
+        Diags.Report(diag::err_cannot_open_file) << InputFile
+                                                 << MB.getError().message();
+        return false;
+      }
+      if (!expandPreprocessedChunks(Input, Opts, Diags, *MB))
+        return false;
+      SourceMgr.overrideFileContents(File, std::move(*MB));
     }
 
     SourceMgr.setMainFileID(
@@ -799,6 +897,9 @@ bool CompilerInstance::InitializeSourceManager(
     }
     std::unique_ptr<llvm::MemoryBuffer> SB = std::move(SBOrErr.get());
 
+    if (!expandPreprocessedChunks(Input, Opts, Diags, SB))
+      return false;
+
     const FileEntry *File = FileMgr.getVirtualFile(SB->getBufferIdentifier(),
                                                    SB->getBufferSize(), 0);
     SourceMgr.setMainFileID(
@@ -813,6 +914,43 @@ bool CompilerInstance::InitializeSourceManager(
 
 // High-Level Operations
 
+/// \brief Print the number of warnings and errors reported for each warning
+/// option, most frequent first.
+static void printDiagnosticGroupCounts(raw_ostream &OS,
+                                       const DiagnosticsEngine &Diags) {
+  typedef llvm::StringMapEntry<DiagnosticsEngine::GroupCount> EntryTy;
+  std::vector<const EntryTy *> Entries;
+  for (const EntryTy &Entry : Diags.getGroupCounts())
+    Entries.push_back(&Entry);
+  if (Entries.empty())
+    return;
+
+  std::sort(Entries.begin(), Entries.end(),
+            [](const EntryTy *LHS, const EntryTy *RHS) {
+              unsigned LCount =
+                  LHS->getValue().Reported + LHS->getValue().Duplicates;
+              unsigned RCount =
+                  RHS->getValue().Reported + RHS->getValue().Duplicates;
+              if (LCount != RCount)
+                return LCount > RCount;
+              return LHS->getKey() < RHS->getKey();
+            });
+
+  OS << "diagnostic counts by group:\n";
+  for (const EntryTy *Entry : Entries) {
+    const DiagnosticsEngine::GroupCount &Count = Entry->getValue();
+    if (Entry->getKey().empty())
+      OS << "  (no group): ";
+    else
+      OS << "  -W" << Entry->getKey() << ": ";
+    OS << Count.Reported + Count.Duplicates;
+    if (Count.Duplicates)
+      OS << " (" << Count.Duplicates << " duplicate"
+         << (Count.Duplicates == 1 ? "" : "s") << " suppressed)";
+    OS << '\n';
+  }
+}
+
 bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
   assert(hasDiagnostics() && "Diagnostics engine is not initialized!");
   assert(!getFrontendOpts().ShowHelp && "Client must handle '-help'!");
@@ -822,6 +960,9 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
   // taking it as an input instead of hard-coding llvm::errs.
   raw_ostream &OS = llvm::errs();
 
+  if (getFrontendOpts().ShowStats)
+    getDiagnostics().setCollectStats();
+
   // Create the target instance.
   setTarget(TargetInfo::CreateTargetInfo(getDiagnostics(),
                                          getInvocation().TargetOpts));
@@ -892,6 +1033,9 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
       OS << " generated.\n";
   }
 
+  if (getDiagnosticOpts().ShowGroupCounts)
+    printDiagnosticGroupCounts(OS, getDiagnostics());
+
   if (getFrontendOpts().ShowStats && hasFileManager()) {
     getFileManager().PrintStats();
     OS << "\n";
@@ -971,6 +1115,9 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   PPOpts.RetainRemappedFileBuffers = true;
     
   Invocation->getDiagnosticOpts().VerifyDiagnostics = 0;
+  Invocation->getDiagnosticOpts().DiagnosticJSONFile.clear();
+  Invocation->getDiagnosticOpts().DiagnosticSARIFFile.clear();
+  Invocation->getDependencyOutputOpts().HeaderCostReportFile.clear();
   assert(ImportingInstance.getInvocation().getModuleHash() ==
          Invocation->getModuleHash() && "Module hash mismatch!");
   
@@ -484,6 +484,12 @@ void FrontendAction::EndSourceFile() {
   // Finalize the action.
   EndSourceFileAction();
 
+  // Report header costs while the AST can still tell which declarations were
+  // referenced.
+  if (HeaderCostCollector *HeaderCosts = CI.getHeaderCostCollector())
+    HeaderCosts->writeReport(CI.hasASTContext() ? &CI.getASTContext() : nullptr,
+                             CI.getDiagnostics());
+
   // Sema references the ast consumer, so reset sema first.
   //
   // FIXME: There is more per-file stuff we could just drop here?
@@ -504,6 +510,7 @@ void FrontendAction::EndSourceFile() {
     CI.getPreprocessor().getIdentifierTable().PrintStats();
     CI.getPreprocessor().getHeaderSearchInfo().PrintStats();
     CI.getSourceManager().PrintStats();
+    CI.getDiagnostics().PrintStats();
     llvm::errs() << "\n";
   }
 
@@ -758,8 +758,21 @@ void PrintPreprocessedAction::ExecuteAction() {
       CI.createDefaultOutputFile(BinaryMode, getCurrentFile());
   if (!OS) return;
 
-  DoPrintPreprocessedInput(CI.getPreprocessor(), OS.get(),
+  StringRef ChunkDir = CI.getFrontendOpts().PreprocessedChunkDir;
+  if (ChunkDir.empty() || !CI.getPreprocessorOutputOpts().ShowCPP) {
+    DoPrintPreprocessedInput(CI.getPreprocessor(), OS.get(),
+                             CI.getPreprocessorOutputOpts());
+    return;
+  }
+
+  // Chunks are only known once the line marker after them is printed, so
+  // collect the whole output before deduplicating it.
+  std::string Output;
+  llvm::raw_string_ostream OutputOS(Output);
+  DoPrintPreprocessedInput(CI.getPreprocessor(), &OutputOS,
                            CI.getPreprocessorOutputOpts());
+  WriteDeduplicatedPreprocessedOutput(OutputOS.str(), ChunkDir, *OS,
+                                      CI.getDiagnostics());
 }
 
 void PrintPreambleAction::ExecuteAction() {
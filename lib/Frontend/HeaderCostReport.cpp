@@ -0,0 +1,184 @@
+//===--- HeaderCostReport.cpp - Report the cost of each header ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements -fheader-cost-report, which lists for each header how
+// much it cost the compilation, to find the headers whose cleanup would speed
+// up a build the most.
+//
+// Time is charged to the innermost file being read. The parser consumes the
+// tokens of a file while it is the innermost one, so this covers both
+// preprocessing and parsing the file, but not work done at the end of the
+// translation unit (template instantiation, code generation), which is
+// charged to the main file.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+using namespace clang;
+
+namespace clang {
+class HeaderCostCallbacks : public PPCallbacks {
+  HeaderCostCollector &Collector;
+  SourceManager &SM;
+
+public:
+  HeaderCostCallbacks(HeaderCostCollector &Collector, SourceManager &SM)
+      : Collector(Collector), SM(SM) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason != EnterFile && Reason != ExitFile)
+      return;
+
+    Collector.chargeTime();
+    if (Reason == ExitFile) {
+      if (!Collector.IncludeStack.empty())
+        Collector.IncludeStack.pop_back();
+      return;
+    }
+
+    HeaderCostCollector::FileCost *Cost = nullptr;
+    if (const FileEntry *FE = SM.getFileEntryForID(SM.getFileID(Loc))) {
+      Cost = &Collector.Costs[FE];
+      ++Cost->Includes;
+      ++Cost->Entries;
+      Cost->Bytes += FE->getSize();
+    }
+    Collector.IncludeStack.push_back(Cost);
+  }
+
+  void FileSkipped(const FileEntry &SkippedFile, const Token &FilenameTok,
+                   SrcMgr::CharacteristicKind FileType) override {
+    ++Collector.Costs[&SkippedFile].Includes;
+  }
+};
+} // end namespace clang
+
+void HeaderCostCollector::attachToPreprocessor(Preprocessor &PP) {
+  SM = &PP.getSourceManager();
+  LastTime = llvm::TimeRecord::getCurrentTime(/*Start=*/false).getWallTime();
+  PP.addPPCallbacks(llvm::make_unique<HeaderCostCallbacks>(*this, *SM));
+  PP.setTokenWatcher([this](const Token &Tok) {
+    if (!IncludeStack.empty() && IncludeStack.back())
+      ++IncludeStack.back()->Tokens;
+  });
+}
+
+void HeaderCostCollector::chargeTime() {
+  double Now = llvm::TimeRecord::getCurrentTime(/*Start=*/false).getWallTime();
+  if (!IncludeStack.empty() && IncludeStack.back())
+    IncludeStack.back()->Seconds += Now - LastTime;
+  LastTime = Now;
+}
+
+void HeaderCostCollector::countDecls(const DeclContext *DC) {
+  // Don't deserialize anything: declarations from AST files were not made by
+  // the headers read in this compilation.
+  for (const Decl *D : DC->noload_decls()) {
+    if (const auto *Inner = dyn_cast<DeclContext>(D))
+      if (!Inner->isFunctionOrMethod())
+        countDecls(Inner);
+
+    // Namespaces and linkage specifications only group other declarations.
+    if (D->isImplicit() || isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D))
+      continue;
+
+    SourceLocation Loc = SM->getExpansionLoc(D->getLocation());
+    if (Loc.isInvalid())
+      continue;
+    const FileEntry *FE = SM->getFileEntryForID(SM->getFileID(Loc));
+    auto Known = Costs.find(FE);
+    if (!FE || Known == Costs.end())
+      continue;
+    ++Known->second.Decls;
+    if (D->isReferenced())
+      ++Known->second.ReferencedDecls;
+  }
+}
+
+void HeaderCostCollector::writeReport(ASTContext *Ctx,
+                                      DiagnosticsEngine &Diags) {
+  if (!SM)
+    return;
+  chargeTime();
+  if (Ctx)
+    countDecls(Ctx->getTranslationUnitDecl());
+
+  std::unique_ptr<llvm::raw_fd_ostream> File;
+  raw_ostream *OS = &llvm::errs();
+  if (OutputPath != "-") {
+    std::error_code EC;
+    File.reset(new llvm::raw_fd_ostream(OutputPath, EC,
+                                        llvm::sys::fs::F_Text));
+    if (EC) {
+      Diags.Report(diag::err_fe_unable_to_open_output) << OutputPath
+                                                       << EC.message();
+      return;
+    }
+    OS = File.get();
+  }
+
+  // List the most expensive headers first.
+  const FileEntry *MainFile = SM->getFileEntryForID(SM->getMainFileID());
+  typedef std::pair<const FileEntry *, const FileCost *> Entry;
+  std::vector<Entry> Headers;
+  FileCost Total;
+  for (const auto &Cost : Costs) {
+    if (Cost.first == MainFile)
+      continue;
+    Headers.push_back(Entry(Cost.first, &Cost.second));
+    Total.Includes += Cost.second.Includes;
+    Total.Entries += Cost.second.Entries;
+    Total.Bytes += Cost.second.Bytes;
+    Total.Tokens += Cost.second.Tokens;
+    Total.Seconds += Cost.second.Seconds;
+    Total.Decls += Cost.second.Decls;
+    Total.ReferencedDecls += Cost.second.ReferencedDecls;
+  }
+  std::sort(Headers.begin(), Headers.end(),
+            [](const Entry &LHS, const Entry &RHS) {
+              if (LHS.second->Seconds != RHS.second->Seconds)
+                return LHS.second->Seconds > RHS.second->Seconds;
+              return StringRef(LHS.first->getName()) <
+                     StringRef(RHS.first->getName());
+            });
+
+  auto PrintRow = [&](const FileCost &Cost, StringRef Name) {
+    *OS << llvm::format("%10.4f %9u %9u %11llu %10llu %8u %11u  ",
+                        Cost.Seconds, Cost.Includes, Cost.Entries,
+                        (unsigned long long)Cost.Bytes,
+                        (unsigned long long)Cost.Tokens, Cost.Decls,
+                        Cost.ReferencedDecls)
+        << Name << '\n';
+  };
+
+  *OS << "*** Header Cost Report";
+  if (MainFile)
+    *OS << " for '" << MainFile->getName() << "'";
+  *OS << ":\n";
+  *OS << "  Time (s)  Includes   Entered       Bytes     Tokens    Decls"
+         "  Referenced  Header\n";
+  for (const Entry &Header : Headers)
+    PrintRow(*Header.second, Header.first->getName());
+  PrintRow(Total, "(total)");
+  OS->flush();
+}
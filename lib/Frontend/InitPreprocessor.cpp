@@ -989,6 +989,11 @@ void clang::InitializePreprocessor(
   if (!PP.getLangOpts().AsmPreprocessor)
     Builder.append("# 1 \"<built-in>\" 3");
 
+  // The macros defined by the compiler and the target may be shared with
+  // other compilations in this process. The line marker is required for that.
+  bool CanCachePredefines =
+      InitOpts.CachePredefines && !PP.getLangOpts().AsmPreprocessor;
+
   // Install things like __POWERPC__, __GNUC__, etc into the macro table.
   if (InitOpts.UsePredefines) {
     if (LangOpts.CUDA && PP.getAuxTargetInfo())
@@ -1008,6 +1013,8 @@ void clang::InitializePreprocessor(
 
       case ARCXX_libstdcxx:
         AddObjCXXARCLibstdcxxDefines(LangOpts, Builder);
+        // This adds declarations, not just macros.
+        CanCachePredefines = false;
         break;
       }
     }
@@ -1019,6 +1026,11 @@ void clang::InitializePreprocessor(
   InitializeStandardPredefinedMacros(PP.getTargetInfo(), PP.getLangOpts(),
                                      FEOpts, Builder);
 
+  // Everything so far only depends on the compiler configuration, so it is
+  // the same for every compilation using it and can be parsed just once.
+  if (CanCachePredefines)
+    PP.setCacheablePredefinesSize(Predefines.tell());
+
   // Add on the predefines from the driver.  Wrap in a #line directive to report
   // that they come from the command line.
   if (!PP.getLangOpts().AsmPreprocessor)
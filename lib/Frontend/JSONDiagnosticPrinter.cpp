@@ -0,0 +1,431 @@
+//===--- JSONDiagnosticPrinter.cpp - JSON/SARIF Diagnostic Printer --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/JSONDiagnosticPrinter.h"
+#include "clang/Basic/CharInfo.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+using namespace clang;
+
+JSONDiagnosticPrinter::JSONDiagnosticPrinter(
+    raw_ostream &os, DiagnosticOptions *diags, OutputFormat Format,
+    std::unique_ptr<raw_ostream> StreamOwner)
+    : OS(os), StreamOwner(std::move(StreamOwner)), Format(Format),
+      LangOpts(nullptr), DiagOpts(diags), StartedLog(false),
+      FinishedLog(false), NumRecords(0) {}
+
+JSONDiagnosticPrinter::~JSONDiagnosticPrinter() {
+  finish();
+}
+
+namespace {
+/// \brief A source location resolved to a presumed file position.
+struct Position {
+  StringRef File;
+  unsigned Line, Column;
+
+  Position() : Line(0), Column(0) {}
+  bool isValid() const { return Line != 0; }
+};
+} // end anonymous namespace
+
+static Position getPosition(const SourceManager &SM, SourceLocation Loc) {
+  Position Pos;
+  if (Loc.isInvalid())
+    return Pos;
+  PresumedLoc PLoc = SM.getPresumedLoc(SM.getExpansionLoc(Loc));
+  if (PLoc.isInvalid())
+    return Pos;
+  Pos.File = PLoc.getFilename();
+  Pos.Line = PLoc.getLine();
+  Pos.Column = PLoc.getColumn();
+  return Pos;
+}
+
+/// \brief Return the positions of the start of \p Range and of the character
+/// just past its end.
+static std::pair<Position, Position>
+getRangePositions(const SourceManager &SM, const LangOptions *LangOpts,
+                  CharSourceRange Range) {
+  SourceLocation End = Range.getEnd();
+  if (End.isMacroID())
+    End = SM.getExpansionRange(End).second;
+  Position EndPos = getPosition(SM, End);
+  if (EndPos.isValid() && Range.isTokenRange() && LangOpts)
+    EndPos.Column += Lexer::MeasureTokenLength(End, SM, *LangOpts);
+  return std::make_pair(getPosition(SM, Range.getBegin()), EndPos);
+}
+
+static void EmitString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\r': OS << "\\r"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << "\\u00" << llvm::hexdigit(C >> 4) << llvm::hexdigit(C & 0xF);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+static StringRef getLevelName(DiagnosticsEngine::Level Level) {
+  switch (Level) {
+  case DiagnosticsEngine::Ignored: return "ignored";
+  case DiagnosticsEngine::Remark:  return "remark";
+  case DiagnosticsEngine::Note:    return "note";
+  case DiagnosticsEngine::Warning: return "warning";
+  case DiagnosticsEngine::Error:   return "error";
+  case DiagnosticsEngine::Fatal:   return "fatal error";
+  }
+  llvm_unreachable("Invalid DiagnosticsEngine level!");
+}
+
+/// \brief Return the SARIF level of a diagnostic, which is one of "note",
+/// "warning" or "error".
+static StringRef getSARIFLevelName(DiagnosticsEngine::Level Level) {
+  switch (Level) {
+  case DiagnosticsEngine::Ignored:
+  case DiagnosticsEngine::Remark:
+  case DiagnosticsEngine::Note:
+    return "note";
+  case DiagnosticsEngine::Warning:
+    return "warning";
+  case DiagnosticsEngine::Error:
+  case DiagnosticsEngine::Fatal:
+    return "error";
+  }
+  llvm_unreachable("Invalid DiagnosticsEngine level!");
+}
+
+/// \brief Return the command line option controlling the diagnostic, if any.
+static std::string getOptionName(DiagnosticsEngine::Level Level,
+                                 unsigned DiagID) {
+  StringRef Option = DiagnosticIDs::getWarningOptionForDiag(DiagID);
+  if (Option.empty())
+    return std::string();
+  return (Level == DiagnosticsEngine::Remark ? "-R" : "-W") + Option.str();
+}
+
+static StringRef getCategoryName(unsigned DiagID) {
+  return DiagnosticIDs::getCategoryNameFromID(
+      DiagnosticIDs::getCategoryNumberForDiag(DiagID));
+}
+
+/// \brief Return the locations of the \#includes leading to \p Loc, innermost
+/// first.
+static SmallVector<Position, 4> getIncludeStack(const SourceManager &SM,
+                                                SourceLocation Loc) {
+  SmallVector<Position, 4> Stack;
+  PresumedLoc PLoc = SM.getPresumedLoc(SM.getExpansionLoc(Loc));
+  while (PLoc.isValid() && PLoc.getIncludeLoc().isValid()) {
+    SourceLocation IncludeLoc = PLoc.getIncludeLoc();
+    Stack.push_back(getPosition(SM, IncludeLoc));
+    PLoc = SM.getPresumedLoc(IncludeLoc);
+  }
+  return Stack;
+}
+
+//===----------------------------------------------------------------------===//
+// JSON Lines
+//===----------------------------------------------------------------------===//
+
+static void EmitJSONPosition(raw_ostream &OS, const Position &Pos) {
+  OS << "{\"file\":";
+  EmitString(OS, Pos.File);
+  OS << ",\"line\":" << Pos.Line << ",\"column\":" << Pos.Column << '}';
+}
+
+static void EmitJSONRecord(raw_ostream &OS, StringRef MainFilename,
+                           DiagnosticsEngine::Level Level,
+                           const Diagnostic &Info, StringRef Message,
+                           const LangOptions *LangOpts) {
+  OS << "{\"main-file\":";
+  EmitString(OS, MainFilename);
+  OS << ",\"level\":";
+  EmitString(OS, getLevelName(Level));
+  OS << ",\"message\":";
+  EmitString(OS, Message);
+
+  std::string Option = getOptionName(Level, Info.getID());
+  if (!Option.empty()) {
+    OS << ",\"option\":";
+    EmitString(OS, Option);
+  }
+  StringRef Category = getCategoryName(Info.getID());
+  if (!Category.empty()) {
+    OS << ",\"category\":";
+    EmitString(OS, Category);
+  }
+
+  if (!Info.hasSourceManager()) {
+    OS << '}';
+    return;
+  }
+  const SourceManager &SM = Info.getSourceManager();
+
+  Position Pos = getPosition(SM, Info.getLocation());
+  if (Pos.isValid()) {
+    OS << ",\"location\":";
+    EmitJSONPosition(OS, Pos);
+  }
+
+  bool First = true;
+  for (const CharSourceRange &Range : Info.getRanges()) {
+    std::pair<Position, Position> Ends =
+        getRangePositions(SM, LangOpts, Range);
+    if (!Ends.first.isValid() || !Ends.second.isValid())
+      continue;
+    OS << (First ? ",\"ranges\":[" : ",") << "{\"begin\":";
+    EmitJSONPosition(OS, Ends.first);
+    OS << ",\"end\":";
+    EmitJSONPosition(OS, Ends.second);
+    OS << '}';
+    First = false;
+  }
+  if (!First)
+    OS << ']';
+
+  First = true;
+  for (const FixItHint &Hint : Info.getFixItHints()) {
+    std::pair<Position, Position> Ends =
+        getRangePositions(SM, LangOpts, Hint.RemoveRange);
+    if (!Ends.first.isValid() || !Ends.second.isValid())
+      continue;
+    OS << (First ? ",\"fixits\":[" : ",") << "{\"begin\":";
+    EmitJSONPosition(OS, Ends.first);
+    OS << ",\"end\":";
+    EmitJSONPosition(OS, Ends.second);
+    OS << ",\"text\":";
+    EmitString(OS, Hint.CodeToInsert);
+    OS << '}';
+    First = false;
+  }
+  if (!First)
+    OS << ']';
+
+  SmallVector<Position, 4> IncludeStack =
+      getIncludeStack(SM, Info.getLocation());
+  if (!IncludeStack.empty()) {
+    OS << ",\"include-stack\":[";
+    for (unsigned I = 0, E = IncludeStack.size(); I != E; ++I) {
+      if (I)
+        OS << ',';
+      EmitJSONPosition(OS, IncludeStack[I]);
+    }
+    OS << ']';
+  }
+  OS << '}';
+}
+
+//===----------------------------------------------------------------------===//
+// SARIF
+//===----------------------------------------------------------------------===//
+
+/// \brief Emit the SARIF artifact URI of \p File: an absolute file:// URI,
+/// or a percent-encoded relative reference for a buffer such as <built-in>
+/// that isn't a file.
+static void EmitSARIFURI(raw_ostream &OS, StringRef File) {
+  SmallString<256> Path(File);
+  std::string URI;
+  if (!File.startswith("<")) {
+    llvm::sys::fs::make_absolute(Path);
+#ifdef LLVM_ON_WIN32
+    std::replace(Path.begin(), Path.end(), '\\', '/');
+#endif
+    URI = Path.startswith("/") ? "file://" : "file:///";
+  }
+
+  for (unsigned char C : Path) {
+    if (isAlphanumeric(C) || C == '/' || C == '-' || C == '.' || C == '_' ||
+        C == '~' || (C == ':' && !URI.empty())) {
+      URI += C;
+    } else {
+      URI += '%';
+      URI += llvm::hexdigit(C >> 4);
+      URI += llvm::hexdigit(C & 0xF);
+    }
+  }
+  EmitString(OS, URI);
+}
+
+static void EmitSARIFLocation(raw_ostream &OS, const Position &Begin,
+                              const Position *End = nullptr) {
+  OS << "{\"physicalLocation\":{\"artifactLocation\":{\"uri\":";
+  EmitSARIFURI(OS, Begin.File);
+  OS << "},\"region\":{\"startLine\":" << Begin.Line
+     << ",\"startColumn\":" << Begin.Column;
+  if (End)
+    OS << ",\"endLine\":" << End->Line << ",\"endColumn\":" << End->Column;
+  OS << "}}}";
+}
+
+static void EmitSARIFResult(raw_ostream &OS, DiagnosticsEngine::Level Level,
+                            const Diagnostic &Info, StringRef Message,
+                            const LangOptions *LangOpts) {
+  OS << '{';
+  std::string Option = getOptionName(Level, Info.getID());
+  if (!Option.empty()) {
+    OS << "\"ruleId\":";
+    EmitString(OS, Option);
+    OS << ',';
+  }
+  OS << "\"level\":";
+  EmitString(OS, getSARIFLevelName(Level));
+  OS << ",\"message\":{\"text\":";
+  EmitString(OS, Message);
+  OS << '}';
+
+  if (Info.hasSourceManager()) {
+    const SourceManager &SM = Info.getSourceManager();
+
+    Position Pos = getPosition(SM, Info.getLocation());
+    if (Pos.isValid()) {
+      OS << ",\"locations\":[";
+      EmitSARIFLocation(OS, Pos);
+      OS << ']';
+    }
+
+    bool First = true;
+    for (const CharSourceRange &Range : Info.getRanges()) {
+      std::pair<Position, Position> Ends =
+          getRangePositions(SM, LangOpts, Range);
+      if (!Ends.first.isValid() || !Ends.second.isValid())
+        continue;
+      OS << (First ? ",\"relatedLocations\":[" : ",");
+      EmitSARIFLocation(OS, Ends.first, &Ends.second);
+      First = false;
+    }
+    if (!First)
+      OS << ']';
+
+    First = true;
+    for (const FixItHint &Hint : Info.getFixItHints()) {
+      std::pair<Position, Position> Ends =
+          getRangePositions(SM, LangOpts, Hint.RemoveRange);
+      if (!Ends.first.isValid() || !Ends.second.isValid())
+        continue;
+      OS << (First ? ",\"fixes\":[" : ",")
+         << "{\"artifactChanges\":[{\"artifactLocation\":{\"uri\":";
+      EmitSARIFURI(OS, Ends.first.File);
+      OS << "},\"replacements\":[{\"deletedRegion\":{\"startLine\":"
+         << Ends.first.Line << ",\"startColumn\":" << Ends.first.Column
+         << ",\"endLine\":" << Ends.second.Line
+         << ",\"endColumn\":" << Ends.second.Column
+         << "},\"insertedContent\":{\"text\":";
+      EmitString(OS, Hint.CodeToInsert);
+      OS << "}}]}]}";
+      First = false;
+    }
+    if (!First)
+      OS << ']';
+
+    SmallVector<Position, 4> IncludeStack =
+        getIncludeStack(SM, Info.getLocation());
+    if (!IncludeStack.empty()) {
+      OS << ",\"stacks\":[{\"message\":{\"text\":\"include stack\"},"
+            "\"frames\":[";
+      for (unsigned I = 0, E = IncludeStack.size(); I != E; ++I) {
+        OS << (I ? ",{\"location\":" : "{\"location\":");
+        EmitSARIFLocation(OS, IncludeStack[I]);
+        OS << '}';
+      }
+      OS << "]}]";
+    }
+  }
+
+  StringRef Category = getCategoryName(Info.getID());
+  if (!Category.empty()) {
+    OS << ",\"properties\":{\"category\":";
+    EmitString(OS, Category);
+    OS << '}';
+  }
+  OS << '}';
+}
+
+void JSONDiagnosticPrinter::startLog(raw_ostream &Out) {
+  StartedLog = true;
+  Out << "{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+         "\"version\":\"2.1.0\",\"runs\":[{\"tool\":{\"driver\":"
+         "{\"name\":\"clang\",\"fullName\":";
+  EmitString(Out, getClangFullVersion());
+  Out << "}},\"results\":[\n";
+}
+
+void JSONDiagnosticPrinter::finish() {
+  if (Format != SARIF || FinishedLog)
+    return;
+
+  SmallString<512> Record;
+  llvm::raw_svector_ostream Out(Record);
+  if (!StartedLog)
+    startLog(Out);
+  Out << "\n]}]}\n";
+  OS << Out.str();
+  OS.flush();
+  FinishedLog = true;
+}
+
+void JSONDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
+                                             const Diagnostic &Info) {
+  // Default implementation (Warnings/errors count).
+  DiagnosticConsumer::HandleDiagnostic(Level, Info);
+
+  // A SARIF log can't be extended once it is closed.
+  if (FinishedLog)
+    return;
+
+  // Initialize the main file name, if we haven't already fetched it.
+  if (MainFilename.empty() && Info.hasSourceManager()) {
+    const SourceManager &SM = Info.getSourceManager();
+    FileID FID = SM.getMainFileID();
+    if (FID.isValid()) {
+      const FileEntry *FE = SM.getFileEntryForID(FID);
+      if (FE && FE->isValid())
+        MainFilename = FE->getName();
+    }
+  }
+
+  SmallString<100> Message;
+  Info.FormatDiagnostic(Message);
+
+  // Format the whole record first, so that it is written at once and records
+  // from compiles appending to the same file don't interleave.
+  SmallString<512> Record;
+  llvm::raw_svector_ostream Out(Record);
+  if (Format == JSON) {
+    EmitJSONRecord(Out, MainFilename, Level, Info, Message, LangOpts);
+    Out << '\n';
+  } else {
+    if (!StartedLog)
+      startLog(Out);
+    else if (NumRecords)
+      Out << ",\n";
+    EmitSARIFResult(Out, Level, Info, Message, LangOpts);
+  }
+
+  OS << Out.str();
+  OS.flush();
+  ++NumRecords;
+}
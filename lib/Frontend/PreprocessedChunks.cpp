@@ -0,0 +1,199 @@
+//===--- PreprocessedChunks.cpp - Deduplicated preprocessed output --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the compact form of -E output used with
+// -preprocessed-chunk-dir, and its expansion back into plain preprocessed
+// output.
+//
+// Line markers split the output into chunks of text, one per stretch of a
+// file between two #includes. Every chunk of at least MinChunkSize bytes is
+// stored in the chunk directory, named after the MD5 of its contents, and
+// replaced in the output by a single line
+//
+//   #include_chunk "<md5>"
+//
+// The same system header usually preprocesses to the same text in every
+// translation unit, so a build ships each such chunk only once. Line markers
+// stay in the output and expansion restores the output byte for byte, so
+// diagnostics locations are unchanged. '#include_chunk' is not a valid
+// directive, so compiling the compact form without expanding it fails
+// instead of silently compiling the wrong code.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/Basic/CharInfo.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <system_error>
+using namespace clang;
+
+/// Chunks shorter than this are left in place; a reference would not save
+/// enough to be worth the extra file.
+enum { MinChunkSize = 1024 };
+
+static const char ChunkDirective[] = "#include_chunk \"";
+
+static void hashChunk(StringRef Chunk, SmallString<32> &Hash) {
+  llvm::MD5 Hasher;
+  Hasher.update(Chunk);
+  llvm::MD5::MD5Result Result;
+  Hasher.final(Result);
+  llvm::MD5::stringifyResult(Result, Hash);
+}
+
+static void getChunkPath(StringRef ChunkDir, StringRef Hash,
+                         SmallVectorImpl<char> &Path) {
+  Path.assign(ChunkDir.begin(), ChunkDir.end());
+  llvm::sys::path::append(Path, Twine(Hash) + ".i");
+}
+
+/// Whether \p Line is a line marker or #line directive written by -E.
+static bool isLineMarker(StringRef Line) {
+  if (Line.startswith("#line "))
+    return true;
+  return Line.size() > 2 && Line[0] == '#' && Line[1] == ' ' &&
+         isDigit(Line[2]);
+}
+
+/// Store \p Chunk in \p ChunkDir unless a chunk with the same hash is already
+/// there. The chunk is written to a temporary file and renamed into place, so
+/// concurrent compiles never see a partial chunk.
+static bool storeChunk(StringRef Chunk, StringRef Hash, StringRef ChunkDir,
+                       DiagnosticsEngine &Diags) {
+  SmallString<256> Path;
+  getChunkPath(ChunkDir, Hash, Path);
+  if (llvm::sys::fs::exists(Path))
+    return true;
+
+  int FD;
+  SmallString<256> TempPath;
+  std::error_code EC = llvm::sys::fs::createUniqueFile(
+      Twine(Path) + "-%%%%%%%%.tmp", FD, TempPath);
+  if (!EC) {
+    {
+      llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+      Out << Chunk;
+      Out.close();
+      if (Out.has_error()) {
+        Out.clear_error();
+        EC = std::make_error_code(std::errc::io_error);
+      }
+    }
+    if (!EC)
+      EC = llvm::sys::fs::rename(TempPath, Path);
+    if (EC)
+      llvm::sys::fs::remove(TempPath);
+  }
+
+  if (EC) {
+    Diags.Report(diag::err_fe_unable_to_write_preprocessed_chunk)
+        << Path << EC.message();
+    return false;
+  }
+  return true;
+}
+
+bool clang::WriteDeduplicatedPreprocessedOutput(StringRef Text,
+                                                StringRef ChunkDir,
+                                                raw_ostream &OS,
+                                                DiagnosticsEngine &Diags) {
+  if (std::error_code EC = llvm::sys::fs::create_directories(ChunkDir)) {
+    Diags.Report(diag::err_fe_unable_to_write_preprocessed_chunk)
+        << ChunkDir << EC.message();
+    return false;
+  }
+
+  // Emit the text from ChunkStart up to End, either as is or as a reference.
+  size_t ChunkStart = 0;
+  auto FlushChunk = [&](size_t End) {
+    StringRef Chunk = Text.slice(ChunkStart, End);
+    ChunkStart = End;
+    if (Chunk.size() < MinChunkSize) {
+      OS << Chunk;
+      return true;
+    }
+
+    SmallString<32> Hash;
+    hashChunk(Chunk, Hash);
+    if (!storeChunk(Chunk, Hash, ChunkDir, Diags))
+      return false;
+    OS << ChunkDirective << Hash << "\"\n";
+    return true;
+  };
+
+  for (size_t Pos = 0, End = Text.size(); Pos != End;) {
+    size_t LineEnd = Text.find('\n', Pos);
+    LineEnd = LineEnd == StringRef::npos ? End : LineEnd + 1;
+    if (isLineMarker(Text.slice(Pos, LineEnd))) {
+      if (!FlushChunk(Pos))
+        return false;
+      OS << Text.slice(Pos, LineEnd);
+      ChunkStart = LineEnd;
+    }
+    Pos = LineEnd;
+  }
+  return FlushChunk(Text.size());
+}
+
+bool clang::ExpandPreprocessedChunks(
+    const llvm::MemoryBuffer &Input, StringRef ChunkDir,
+    DiagnosticsEngine &Diags, std::unique_ptr<llvm::MemoryBuffer> &Expanded) {
+  StringRef Text = Input.getBuffer();
+  SmallString<0> Result;
+  size_t CopiedUpTo = 0;
+  for (size_t Pos = 0, End = Text.size(); Pos != End;) {
+    size_t LineEnd = Text.find('\n', Pos);
+    LineEnd = LineEnd == StringRef::npos ? End : LineEnd + 1;
+    StringRef Line = Text.slice(Pos, LineEnd).rtrim("\r\n");
+    if (!Line.startswith(ChunkDirective) || !Line.endswith("\"")) {
+      Pos = LineEnd;
+      continue;
+    }
+
+    StringRef Hash =
+        Line.drop_front(llvm::array_lengthof(ChunkDirective) - 1).drop_back();
+    SmallString<256> Path;
+    getChunkPath(ChunkDir, Hash, Path);
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Chunk =
+        llvm::MemoryBuffer::getFile(Path);
+    if (!Chunk) {
+      Diags.Report(diag::err_fe_unable_to_read_preprocessed_chunk)
+          << Path << Chunk.getError().message();
+      return false;
+    }
+
+    // A chunk is shared between many compiles; make sure it wasn't damaged.
+    SmallString<32> ActualHash;
+    hashChunk((*Chunk)->getBuffer(), ActualHash);
+    if (ActualHash != Hash) {
+      Diags.Report(diag::err_fe_unable_to_read_preprocessed_chunk)
+          << Path << "contents do not match the hash";
+      return false;
+    }
+
+    Result += Text.slice(CopiedUpTo, Pos);
+    Result += (*Chunk)->getBuffer();
+    CopiedUpTo = Pos = LineEnd;
+  }
+
+  Expanded = nullptr;
+  if (CopiedUpTo == 0)
+    return true;
+  Result += Text.substr(CopiedUpTo);
+  Expanded =
+      llvm::MemoryBuffer::getMemBufferCopy(Result, Input.getBufferIdentifier());
+  return true;
+}
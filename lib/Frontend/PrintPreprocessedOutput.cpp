@@ -625,12 +625,56 @@ struct UnknownPragmaHandler : public PragmaHandler {
 } // end anonymous namespace
 
 
+namespace {
+/// \brief Finds the characters of tokens spelled directly in a file.
+///
+/// Nearly every token printed in a row comes from the same file, so the last
+/// file buffer is remembered and a token's characters are found by offsetting
+/// its location into that buffer, instead of decomposing the location in the
+/// SourceManager for every token.
+class FileSpellingCache {
+  const SourceManager &SM;
+  unsigned StartOffset;
+  unsigned Size;
+  const char *BufferStart;
+
+public:
+  explicit FileSpellingCache(const SourceManager &SM)
+      : SM(SM), StartOffset(0), Size(0), BufferStart(nullptr) {}
+
+  /// \brief Return the characters at \p Loc, or null if \p Loc is not a
+  /// location in a file buffer.
+  const char *getCharacterData(SourceLocation Loc) {
+    if (!Loc.isFileID())
+      return nullptr;
+
+    unsigned Offset = Loc.getRawEncoding();
+    if (Offset - StartOffset < Size)
+      return BufferStart + (Offset - StartOffset);
+
+    FileID FID = SM.getFileID(Loc);
+    bool Invalid = false;
+    StringRef Buffer = SM.getBufferData(FID, &Invalid);
+    if (Invalid)
+      return nullptr;
+    StartOffset = SM.getLocForStartOfFile(FID).getRawEncoding();
+    Size = Buffer.size();
+    BufferStart = Buffer.data();
+    if (Offset - StartOffset >= Size)
+      return nullptr;
+    return BufferStart + (Offset - StartOffset);
+  }
+};
+} // end anonymous namespace
+
 static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                                     PrintPPOutputPPCallbacks *Callbacks,
                                     raw_ostream &OS) {
   bool DropComments = PP.getLangOpts().TraditionalCPP &&
                       !PP.getCommentRetentionState();
 
+  FileSpellingCache FileSpellings(PP.getSourceManager());
+  const char *TokPtr;
   char Buffer[256];
   Token PrevPrevTok, PrevTok;
   PrevPrevTok.startToken();
@@ -671,8 +715,18 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
     } else if (Tok.isLiteral() && !Tok.needsCleaning() &&
                Tok.getLiteralData()) {
       OS.write(Tok.getLiteralData(), Tok.getLength());
+    } else if (!Tok.needsCleaning() &&
+               (TokPtr = FileSpellings.getCharacterData(Tok.getLocation()))) {
+      // The token is spelled exactly as written in a file; copy it straight
+      // from the file buffer.
+      OS.write(TokPtr, Tok.getLength());
+
+      // Tokens that can contain embedded newlines need to adjust our current
+      // line number.
+      if (Tok.getKind() == tok::comment || Tok.getKind() == tok::unknown)
+        Callbacks->HandleNewlinesInToken(TokPtr, Tok.getLength());
     } else if (Tok.getLength() < 256) {
-      const char *TokPtr = Buffer;
+      TokPtr = Buffer;
       unsigned Len = PP.getSpelling(Tok, TokPtr);
       OS.write(TokPtr, Len);
 
@@ -735,6 +789,9 @@ static void DoPrintMacros(Preprocessor &PP, raw_ostream *OS) {
   }
 }
 
+/// The size of the output buffer used by -E.
+enum { PreprocessedOutputBufferSize = 256 * 1024 };
+
 /// DoPrintPreprocessedInput - This implements -E mode.
 ///
 void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
@@ -746,6 +803,11 @@ void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
     return;
   }
 
+  // Output is produced a token at a time; give a buffered stream a large
+  // buffer so that it reaches the file in a few big writes.
+  if (OS->GetBufferSize() && OS->GetBufferSize() < PreprocessedOutputBufferSize)
+    OS->SetBufferSize(PreprocessedOutputBufferSize);
+
   // Inform the preprocessor whether we want it to retain comments or not, due
   // to -C or -CC.
   PP.SetCommentRetentionState(Opts.ShowComments, Opts.ShowMacroComments);
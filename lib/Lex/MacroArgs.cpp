@@ -155,11 +155,21 @@ MacroArgs::getPreExpArgument(unsigned Arg, const MacroInfo *MI,
   std::vector<Token> &Result = PreExpArgTokens[Arg];
   if (!Result.empty()) return Result;
 
-  SaveAndRestore<bool> PreExpandingMacroArgs(PP.InMacroArgPreExpansion, true);
-
   const Token *AT = getUnexpArgument(Arg);
   unsigned NumToks = getArgLength(AT)+1;  // Include the EOF.
 
+  // If an identical argument was pre-expanded before, replay that instead of
+  // lexing the argument again.
+  std::string Key;
+  if (PP.replayPreExpandedArgument(MI, makeArrayRef(AT, NumToks), Key, Result))
+    return Result;
+  ++PP.NumPreExpandedArgs;
+
+  SaveAndRestore<bool> PreExpandingMacroArgs(PP.InMacroArgPreExpansion, true);
+  Preprocessor::MacroArgPreExpansion Record;
+  SaveAndRestore<Preprocessor::MacroArgPreExpansion *> RecordExpansions(
+      PP.CurMacroArgPreExpansion, Key.empty() ? nullptr : &Record);
+
   // Otherwise, we have to pre-expand this argument, populating Result.  To do
   // this, we set up a fake TokenLexer to lex from the unexpanded argument
   // list.  With this installed, we lex expanded tokens until we hit the EOF
@@ -174,6 +184,8 @@ MacroArgs::getPreExpArgument(unsigned Arg, const MacroInfo *MI,
     PP.Lex(Tok);
   } while (Result.back().isNot(tok::eof));
 
+  PP.recordPreExpandedArgument(Key, makeArrayRef(AT, NumToks), Result, Record);
+
   // Pop the token stream off the top of the stack.  We know that the internal
   // pointer inside of it is to the "end" of the token stream, but the stack
   // will not otherwise be popped until the next token is lexed.  The problem is
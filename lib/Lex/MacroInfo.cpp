@@ -25,6 +25,8 @@ MacroInfo::MacroInfo(SourceLocation DefLoc)
     IsGNUVarargs(false),
     IsBuiltinMacro(false),
     HasCommaPasting(false),
+    UsesArguments(false),
+    IsArgumentUseCached(false),
     IsDisabled(false),
     IsUsed(false),
     IsAllowRedefinitionsWithoutWarning(false),
@@ -62,6 +64,17 @@ unsigned MacroInfo::getDefinitionLengthSlow(SourceManager &SM) const {
   return DefinitionLength;
 }
 
+bool MacroInfo::usesArgumentsSlow() const {
+  IsArgumentUseCached = true;
+  UsesArguments = false;
+  for (const Token &Tok : ReplacementTokens) {
+    const IdentifierInfo *II = Tok.getIdentifierInfo();
+    if (II && getArgumentNum(II) != -1)
+      return (UsesArguments = true);
+  }
+  return false;
+}
+
 /// \brief Return true if the specified macro definition is equal to
 /// this macro in spelling, arguments, and whitespace.
 ///
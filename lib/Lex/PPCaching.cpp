@@ -24,7 +24,7 @@ using namespace clang;
 // be called multiple times and CommitBacktrackedTokens/Backtrack calls will
 // be combined with the EnableBacktrackAtThisPos calls in reverse order.
 void Preprocessor::EnableBacktrackAtThisPos() {
-  BacktrackPositions.push_back(CachedLexPos);
+  BacktrackPositions.push_back(CachedTokens.size());
   EnterCachingLexMode();
 }
 
@@ -33,6 +33,10 @@ void Preprocessor::CommitBacktrackedTokens() {
   assert(!BacktrackPositions.empty()
          && "EnableBacktrackAtThisPos was not called!");
   BacktrackPositions.pop_back();
+
+  // Nothing can return to the lexed tokens anymore.
+  if (BacktrackPositions.empty())
+    CachedTokens.clear();
 }
 
 // Make Preprocessor re-lex the tokens that were lexed since
@@ -40,8 +44,15 @@ void Preprocessor::CommitBacktrackedTokens() {
 void Preprocessor::Backtrack() {
   assert(!BacktrackPositions.empty()
          && "EnableBacktrackAtThisPos was not called!");
-  CachedLexPos = BacktrackPositions.back();
+  CachedTokensTy::iterator Pos =
+      CachedTokens.begin() + BacktrackPositions.back();
   BacktrackPositions.pop_back();
+
+  CachedTokensAhead.insert(CachedTokensAhead.begin(), Pos, CachedTokens.end());
+  if (BacktrackPositions.empty())
+    CachedTokens.clear();
+  else
+    CachedTokens.erase(Pos, CachedTokens.end());
   recomputeCurLexerKind();
 }
 
@@ -49,8 +60,11 @@ void Preprocessor::CachingLex(Token &Result) {
   if (!InCachingLexMode())
     return;
 
-  if (CachedLexPos < CachedTokens.size()) {
-    Result = CachedTokens[CachedLexPos++];
+  if (!CachedTokensAhead.empty()) {
+    Result = CachedTokensAhead.front();
+    CachedTokensAhead.pop_front();
+    if (isBacktrackEnabled())
+      CachedTokens.push_back(Result);
     return;
   }
 
@@ -61,16 +75,14 @@ void Preprocessor::CachingLex(Token &Result) {
     // Cache the lexed token.
     EnterCachingLexMode();
     CachedTokens.push_back(Result);
-    ++CachedLexPos;
     return;
   }
 
-  if (CachedLexPos < CachedTokens.size()) {
+  if (!CachedTokensAhead.empty()) {
     EnterCachingLexMode();
   } else {
     // All cached tokens were consumed.
-    CachedTokens.clear();
-    CachedLexPos = 0;
+    ++TokenCacheGeneration;
   }
 }
 
@@ -84,34 +96,32 @@ void Preprocessor::EnterCachingLexMode() {
 
 
 const Token &Preprocessor::PeekAhead(unsigned N) {
-  assert(CachedLexPos + N > CachedTokens.size() && "Confused caching.");
+  assert(N > CachedTokensAhead.size() && "Confused caching.");
   ExitCachingLexMode();
-  for (unsigned C = CachedLexPos + N - CachedTokens.size(); C > 0; --C) {
-    CachedTokens.push_back(Token());
-    Lex(CachedTokens.back());
+  for (unsigned C = N - CachedTokensAhead.size(); C > 0; --C) {
+    CachedTokensAhead.push_back(Token());
+    Lex(CachedTokensAhead.back());
   }
   EnterCachingLexMode();
-  return CachedTokens.back();
+  return CachedTokensAhead.back();
 }
 
 void Preprocessor::AnnotatePreviousCachedTokens(const Token &Tok) {
   assert(Tok.isAnnotation() && "Expected annotation token");
-  assert(CachedLexPos != 0 && "Expected to have some cached tokens");
-  assert(CachedTokens[CachedLexPos-1].getLastLoc() == Tok.getAnnotationEndLoc()
+  assert(!CachedTokens.empty() && "Expected to have some cached tokens");
+  assert(CachedTokens.back().getLastLoc() == Tok.getAnnotationEndLoc()
          && "The annotation should be until the most recent cached token");
 
   // Start from the end of the cached tokens list and look for the token
   // that is the beginning of the annotation token.
-  for (CachedTokensTy::size_type i = CachedLexPos; i != 0; --i) {
+  for (CachedTokensTy::size_type i = CachedTokens.size(); i != 0; --i) {
     CachedTokensTy::iterator AnnotBegin = CachedTokens.begin() + i-1;
     if (AnnotBegin->getLocation() == Tok.getLocation()) {
       assert((BacktrackPositions.empty() || BacktrackPositions.back() < i) &&
              "The backtrack pos points inside the annotated tokens!");
       // Replace the cached tokens with the single annotation token.
-      if (i < CachedLexPos)
-        CachedTokens.erase(AnnotBegin + 1, CachedTokens.begin() + CachedLexPos);
+      CachedTokens.erase(AnnotBegin + 1, CachedTokens.end());
       *AnnotBegin = Tok;
-      CachedLexPos = i;
       return;
     }
   }
@@ -119,10 +129,10 @@ void Preprocessor::AnnotatePreviousCachedTokens(const Token &Tok) {
 
 bool Preprocessor::IsPreviousCachedToken(const Token &Tok) const {
   // There's currently no cached token...
-  if (!CachedLexPos)
+  if (CachedTokens.empty())
     return false;
 
-  const Token LastCachedTok = CachedTokens[CachedLexPos - 1];
+  const Token LastCachedTok = CachedTokens.back();
   if (LastCachedTok.getKind() != Tok.getKind())
     return false;
 
@@ -136,9 +146,7 @@ bool Preprocessor::IsPreviousCachedToken(const Token &Tok) const {
 }
 
 void Preprocessor::ReplacePreviousCachedToken(ArrayRef<Token> NewToks) {
-  assert(CachedLexPos != 0 && "Expected to have some cached tokens");
-  CachedTokens.insert(CachedTokens.begin() + CachedLexPos - 1, NewToks.begin(),
-                      NewToks.end());
-  CachedTokens.erase(CachedTokens.begin() + CachedLexPos - 1 + NewToks.size());
-  CachedLexPos += NewToks.size() - 1;
+  assert(!CachedTokens.empty() && "Expected to have some cached tokens");
+  CachedTokens.pop_back();
+  CachedTokens.append(NewToks.begin(), NewToks.end());
 }
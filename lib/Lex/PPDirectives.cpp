@@ -909,6 +909,10 @@ void Preprocessor::HandleDirective(Token &Result) {
 
   ++NumDirectives;
 
+  // A directive can change what macros expand to, or which diagnostics are
+  // enabled; don't reuse macro argument pre-expansions across it.
+  ++MacroStateGeneration;
+
   // We are about to read a token.  For the multiple-include optimization FA to
   // work, we have to remember if we had read any tokens *before* this
   // pp-directive.
@@ -192,11 +192,10 @@ void Preprocessor::EnterTokenStream(const Token *Toks, unsigned NumToks,
                                     bool DisableMacroExpansion,
                                     bool OwnsTokens) {
   if (CurLexerKind == CLK_CachingLexer) {
-    if (CachedLexPos < CachedTokens.size()) {
+    if (!CachedTokensAhead.empty()) {
       // We're entering tokens into the middle of our cached token stream. We
       // can't represent that, so just insert the tokens into the buffer.
-      CachedTokens.insert(CachedTokens.begin() + CachedLexPos,
-                          Toks, Toks + NumToks);
+      CachedTokensAhead.insert(CachedTokensAhead.begin(), Toks, Toks + NumToks);
       if (OwnsTokens)
         delete [] Toks;
       return;
@@ -620,6 +619,7 @@ void Preprocessor::HandleMicrosoftCommentPaste(Token &Tok) {
 }
 
 void Preprocessor::EnterSubmodule(Module *M, SourceLocation ImportLoc) {
+  ++MacroStateGeneration;
   if (!getLangOpts().ModulesLocalVisibility) {
     // Just track that we entered this submodule.
     BuildingSubmoduleStack.push_back(BuildingSubmoduleInfo(
@@ -689,6 +689,7 @@ bool Preprocessor::needModuleMacros() const {
 }
 
 void Preprocessor::LeaveSubmodule() {
+  ++MacroStateGeneration;
   auto &Info = BuildingSubmoduleStack.back();
 
   Module *LeavingMod = Info.M;
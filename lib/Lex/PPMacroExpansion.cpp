@@ -44,6 +44,7 @@ Preprocessor::getLocalMacroDirectiveHistory(const IdentifierInfo *II) const {
 void Preprocessor::appendMacroDirective(IdentifierInfo *II, MacroDirective *MD){
   assert(MD && "MacroDirective should be non-zero!");
   assert(!MD->getPrevious() && "Already attached to a MacroDirective history.");
+  ++MacroStateGeneration;
 
   MacroState &StoredMD = CurSubmoduleState->Macros[II];
   auto *OldMD = StoredMD.getLatest();
@@ -83,6 +84,7 @@ ModuleMacro *Preprocessor::addModuleMacro(Module *Mod, IdentifierInfo *II,
                                           MacroInfo *Macro,
                                           ArrayRef<ModuleMacro *> Overrides,
                                           bool &New) {
+  ++MacroStateGeneration;
   llvm::FoldingSetNodeID ID;
   ModuleMacro::Profile(ID, Mod, II);
 
@@ -419,6 +421,18 @@ bool Preprocessor::HandleMacroExpandedIdentifier(Token &Identifier,
                                                  const MacroDefinition &M) {
   MacroInfo *MI = M.getMacroInfo();
 
+  // Note the expansion if we are recording the pre-expansion of an argument.
+  if (CurMacroArgPreExpansion) {
+    if (!MI->isObjectLike() || MI->isBuiltinMacro() || M.isAmbiguous() ||
+        InMacroArgs ||
+        std::any_of(MI->tokens_begin(), MI->tokens_end(),
+                    [](const Token &Tok) { return Tok.is(tok::hashhash); }))
+      CurMacroArgPreExpansion->Replayable = false;
+    else
+      CurMacroArgPreExpansion->Expansions.push_back(
+          std::make_pair(Identifier.getLocation(), M));
+  }
+
   // If this is a macro expansion in the "#if !defined(x)" line for the file,
   // then the macro could expand to different things in other contexts, we need
   // to disable the optimization in this case.
@@ -516,6 +530,7 @@ bool Preprocessor::HandleMacroExpandedIdentifier(Token &Identifier,
     Identifier.setFlag(Token::LeadingEmptyMacro);
     PropagateLineStartLeadingSpaceInfo(Identifier);
     ++NumFastMacroExpanded;
+    ++NumEmptyMacroExpanded;
     return false;
   } else if (MI->getNumTokens() == 1 &&
              isTrivialSingleTokenExpansion(MI, Identifier.getIdentifierInfo(),
@@ -565,11 +580,204 @@ bool Preprocessor::HandleMacroExpandedIdentifier(Token &Identifier,
     return true;
   }
 
+  // If the replacement list doesn't refer to the arguments, the TokenLexer
+  // has nothing to substitute; release the arguments right away.
+  if (Args && !MI->usesArguments()) {
+    Args->destroy(*this);
+    Args = nullptr;
+    ++NumArgFreeFnMacroExpanded;
+  }
+
   // Start expanding the macro.
   EnterMacro(Identifier, ExpansionEnd, MI, Args);
   return false;
 }
 
+/// The number of recorded macro argument pre-expansions kept before they are
+/// all dropped, and the longest argument which is recorded.
+enum { MaxPreExpandedArgs = 1024, MaxPreExpandedArgTokens = 64 };
+
+/// Whether lexing \p II does nothing other than possibly expanding it as a
+/// macro; in particular, emits no diagnostics.
+static bool isPlainIdentifier(const IdentifierInfo *II) {
+  return !II->isPoisoned() && !II->isExtensionToken() &&
+         !II->isFutureCompatKeyword() && !II->isCPlusPlusOperatorKeyword() &&
+         !II->isOutOfDate() && !II->isModulesImport();
+}
+
+template <typename T> static void appendBytes(std::string &Key, const T &Val) {
+  Key.append(reinterpret_cast<const char *>(&Val), sizeof(Val));
+}
+
+bool Preprocessor::replayPreExpandedArgument(const MacroInfo *MI,
+                                             ArrayRef<Token> ArgTokens,
+                                             std::string &Key,
+                                             std::vector<Token> &Result) {
+  Key.clear();
+  if (OnToken || DisableMacroExpansion || InMacroArgs ||
+      ArgTokens.size() > MaxPreExpandedArgTokens)
+    return false;
+
+  // Key on the spelling of the tokens; their locations differ every time.
+  appendBytes(Key, MI);
+  for (const Token &Tok : ArgTokens) {
+    if (Tok.isAnnotation() || Tok.isOneOf(tok::raw_identifier,
+                                          tok::code_completion)) {
+      Key.clear();
+      return false;
+    }
+    appendBytes(Key, Tok.getKind());
+    appendBytes(Key, Tok.getFlags());
+    appendBytes(Key, Tok.getLength());
+    if (Tok.isLiteral()) {
+      if (!Tok.getLiteralData()) {
+        Key.clear();
+        return false;
+      }
+      Key.append(Tok.getLiteralData(), Tok.getLength());
+    } else if (const IdentifierInfo *II = Tok.getIdentifierInfo()) {
+      if (!isPlainIdentifier(II)) {
+        Key.clear();
+        return false;
+      }
+      appendBytes(Key, II);
+    }
+  }
+
+  if (PreExpandedArgsGeneration != MacroStateGeneration) {
+    PreExpandedArgs.clear();
+    PreExpandedArgsGeneration = MacroStateGeneration;
+  }
+  auto Known = PreExpandedArgs.find(Key);
+  if (Known == PreExpandedArgs.end() || !DelayedMacroExpandsCallbacks.empty())
+    return false;
+  const PreExpandedArgument &Recorded = Known->second;
+
+  // Which macros are currently being expanded is not part of the key. The
+  // macros must expand, and the identifiers that were left alone must be left
+  // alone, just like they were when the pre-expansion was recorded.
+  for (const auto &Expansion : Recorded.Expansions)
+    if (!Expansion.Definition.getMacroInfo()->isEnabled())
+      return false;
+  for (const Token &Tok : Recorded.Tokens)
+    if (const IdentifierInfo *II = Tok.getIdentifierInfo())
+      if (II->hasMacroDefinition())
+        if (const MacroInfo *IdentMI = getMacroInfo(II))
+          if (!IdentMI->isEnabled())
+            return false;
+
+  // Do what expanding the macros would have done.
+  if (CurPPLexer && !Recorded.Expansions.empty())
+    CurPPLexer->MIOpt.ExpandedMacro();
+  for (const auto &Expansion : Recorded.Expansions) {
+    const Token &Identifier = ArgTokens[Expansion.ArgToken];
+    ++NumMacroExpanded;
+    markMacroAsUsed(Expansion.Definition.getMacroInfo());
+    if (Callbacks)
+      Callbacks->MacroExpands(Identifier, Expansion.Definition,
+                              Identifier.getLocation(), /*Args=*/nullptr);
+  }
+
+  SmallVector<SourceLocation, 2> ChunkStarts;
+  for (const auto &Chunk : Recorded.Chunks) {
+    SourceLocation ExpandLoc = ArgTokens[Chunk.ArgToken].getLocation();
+    ChunkStarts.push_back(SourceMgr.createExpansionLoc(
+        Chunk.SpellingLoc, ExpandLoc, ExpandLoc, Chunk.Length));
+  }
+
+  Result.clear();
+  Result.reserve(Recorded.Tokens.size());
+  for (unsigned I = 0, E = Recorded.Tokens.size(); I != E; ++I) {
+    const PreExpandedArgument::TokenOrigin &Origin = Recorded.Origins[I];
+    Result.push_back(Recorded.Tokens[I]);
+    Token &Tok = Result.back();
+    if (Origin.FromArgument) {
+      const Token &ArgTok = ArgTokens[Origin.Index];
+      Tok.setLocation(ArgTok.getLocation());
+      if (Tok.isLiteral())
+        Tok.setLiteralData(ArgTok.getLiteralData());
+    } else {
+      Tok.setLocation(ChunkStarts[Origin.Index].getLocWithOffset(
+          Origin.Offset));
+    }
+  }
+
+  ++NumReplayedPreExpandedArgs;
+  return true;
+}
+
+void Preprocessor::recordPreExpandedArgument(
+    StringRef Key, ArrayRef<Token> ArgTokens, ArrayRef<Token> Expanded,
+    const MacroArgPreExpansion &Record) {
+  if (Key.empty() || !Record.Replayable ||
+      PreExpandedArgsGeneration != MacroStateGeneration)
+    return;
+
+  auto findArgToken = [&](SourceLocation Loc, unsigned &Index) {
+    for (unsigned I = 0, E = ArgTokens.size(); I != E; ++I)
+      if (ArgTokens[I].getLocation() == Loc) {
+        Index = I;
+        return true;
+      }
+    return false;
+  };
+
+  PreExpandedArgument Recorded;
+  for (const auto &Expansion : Record.Expansions) {
+    PreExpandedArgument::Expansion E;
+    // Only the argument's own identifiers can be replayed.
+    if (!findArgToken(Expansion.first, E.ArgToken))
+      return;
+    E.Definition = Expansion.second;
+    Recorded.Expansions.push_back(E);
+  }
+
+  SmallVector<FileID, 2> ChunkIDs;
+  for (const Token &Tok : Expanded) {
+    if (Tok.isAnnotation() || Tok.isExpandDisabled())
+      return;
+    if (const IdentifierInfo *II = Tok.getIdentifierInfo())
+      if (!isPlainIdentifier(II))
+        return;
+
+    PreExpandedArgument::TokenOrigin Origin;
+    Origin.Offset = 0;
+    Origin.FromArgument = findArgToken(Tok.getLocation(), Origin.Index);
+    if (!Origin.FromArgument) {
+      // The token was produced by expanding one of the argument's identifiers.
+      SourceLocation Loc = Tok.getLocation();
+      if (!Loc.isMacroID())
+        return;
+      std::pair<FileID, unsigned> Decomposed = SourceMgr.getDecomposedLoc(Loc);
+      const SrcMgr::ExpansionInfo &Info =
+          SourceMgr.getSLocEntry(Decomposed.first).getExpansion();
+      if (Info.isMacroArgExpansion() ||
+          Info.getExpansionLocStart() != Info.getExpansionLocEnd())
+        return;
+
+      auto Known = std::find(ChunkIDs.begin(), ChunkIDs.end(),
+                             Decomposed.first);
+      Origin.Index = Known - ChunkIDs.begin();
+      Origin.Offset = Decomposed.second;
+      if (Known == ChunkIDs.end()) {
+        PreExpandedArgument::Chunk Chunk;
+        if (!findArgToken(Info.getExpansionLocStart(), Chunk.ArgToken))
+          return;
+        Chunk.SpellingLoc = Info.getSpellingLoc();
+        Chunk.Length = SourceMgr.getFileIDSize(Decomposed.first);
+        ChunkIDs.push_back(Decomposed.first);
+        Recorded.Chunks.push_back(Chunk);
+      }
+    }
+    Recorded.Tokens.push_back(Tok);
+    Recorded.Origins.push_back(Origin);
+  }
+
+  if (PreExpandedArgs.size() >= MaxPreExpandedArgs)
+    PreExpandedArgs.clear();
+  PreExpandedArgs[Key] = std::move(Recorded);
+}
+
 enum Bracket {
   Brace,
   Paren
@@ -1541,6 +1749,8 @@ void Preprocessor::ExpandBuiltinMacro(Token &Tok) {
   IdentifierInfo *II = Tok.getIdentifierInfo();
   assert(II && "Can't be a macro without id info!");
 
+  ++NumBuiltinMacroExpanded;
+
   // If this is an _Pragma or Microsoft __pragma directive, expand it,
   // invoke the pragma handler, then lex the token after it.
   if (II == Ident_Pragma)
@@ -1548,8 +1758,6 @@ void Preprocessor::ExpandBuiltinMacro(Token &Tok) {
   else if (II == Ident__pragma) // in non-MS mode this is null
     return HandleMicrosoft__pragma(Tok);
 
-  ++NumBuiltinMacroExpanded;
-
   SmallString<128> TmpBuffer;
   llvm::raw_svector_ostream OS(TmpBuffer);
 
@@ -102,6 +102,7 @@ void PragmaNamespace::HandlePragma(Preprocessor &PP,
 /// rest of the pragma, passing it to the registered pragma handlers.
 void Preprocessor::HandlePragmaDirective(SourceLocation IntroducerLoc,
                                          PragmaIntroducerKind Introducer) {
+  ++MacroStateGeneration;
   if (Callbacks)
     Callbacks->PragmaDirective(IntroducerLoc, Introducer);
 
@@ -0,0 +1,201 @@
+//===--- PredefinesCache.cpp - Cache of parsed predefined macros ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the process-wide predefines cache, and the Preprocessor
+// methods which record the predefined macros into it and install them from it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/PredefinesCache.h"
+#include "clang/Lex/MacroInfo.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/MutexGuard.h"
+using namespace clang;
+
+/// The line marker every cacheable predefines prefix starts with.
+static const char BuiltinLineMarker[] = "# 1 \"<built-in>\" 3\n";
+
+namespace {
+struct PredefinesCacheImpl {
+  llvm::sys::Mutex Lock;
+  llvm::StringMap<std::shared_ptr<const PreparsedMacros>> Entries;
+};
+} // end anonymous namespace
+
+static llvm::ManagedStatic<PredefinesCacheImpl> ThePredefinesCache;
+
+/// The number of distinct predefines kept before the cache is flushed. A
+/// process rarely compiles for more than a handful of configurations.
+enum { MaxPredefinesCacheEntries = 16 };
+
+std::shared_ptr<const PreparsedMacros>
+PredefinesCache::lookup(StringRef Text) {
+  llvm::MutexGuard Guard(ThePredefinesCache->Lock);
+  auto Known = ThePredefinesCache->Entries.find(Text);
+  if (Known == ThePredefinesCache->Entries.end())
+    return nullptr;
+  return Known->second;
+}
+
+void PredefinesCache::insert(StringRef Text,
+                             std::shared_ptr<const PreparsedMacros> Macros) {
+  llvm::MutexGuard Guard(ThePredefinesCache->Lock);
+  if (ThePredefinesCache->Entries.size() >= MaxPredefinesCacheEntries)
+    ThePredefinesCache->Entries.clear();
+  ThePredefinesCache->Entries[Text] = std::move(Macros);
+}
+
+void PredefinesCache::clear() {
+  llvm::MutexGuard Guard(ThePredefinesCache->Lock);
+  ThePredefinesCache->Entries.clear();
+}
+
+std::shared_ptr<const PreparsedMacros>
+Preprocessor::collectPredefinedMacros(unsigned PrefixSize) const {
+  FileID FID = getPredefinesFileID();
+  if (FID.isInvalid())
+    return nullptr;
+
+  bool Invalid = false;
+  StringRef Buffer = SourceMgr.getBufferData(FID, &Invalid);
+  if (Invalid || PrefixSize > Buffer.size() ||
+      !Buffer.startswith(BuiltinLineMarker))
+    return nullptr;
+
+  auto getPrefixOffset = [&](SourceLocation Loc, unsigned &Offset) {
+    if (Loc.isInvalid() || !Loc.isFileID())
+      return false;
+    std::pair<FileID, unsigned> Decomposed = SourceMgr.getDecomposedLoc(Loc);
+    Offset = Decomposed.second;
+    return Decomposed.first == FID && Offset < PrefixSize;
+  };
+
+  auto Result = std::make_shared<PreparsedMacros>(PrefixSize);
+  for (const auto &Macro : macros(/*IncludeExternalMacros=*/false)) {
+    // Find the last definition made by the prefix; anything after it came
+    // from the command line or the main file.
+    for (MacroDirective *MD = getLocalMacroDirectiveHistory(Macro.first); MD;
+         MD = MD->getPrevious()) {
+      auto *DefMD = dyn_cast<DefMacroDirective>(MD);
+      PreparsedMacros::Definition Def;
+      if (!DefMD || !getPrefixOffset(DefMD->getInfo()->getDefinitionLoc(),
+                                     Def.DefinitionOffset))
+        continue;
+
+      const MacroInfo *MI = DefMD->getInfo();
+      if (!getPrefixOffset(MI->getDefinitionEndLoc(), Def.DefinitionEndOffset))
+        return nullptr;
+      Def.Name = Macro.first->getName();
+      Def.IsFunctionLike = MI->isFunctionLike();
+      Def.IsC99Varargs = MI->isC99Varargs();
+      Def.IsGNUVarargs = MI->isGNUVarargs();
+      Def.HasCommaPasting = MI->hasCommaPasting();
+      for (const IdentifierInfo *Arg : MI->args())
+        Def.Arguments.push_back(Arg->getName());
+      for (const Token &Tok : MI->tokens()) {
+        PreparsedMacros::TokenInfo Info;
+        if (!getPrefixOffset(Tok.getLocation(), Info.Offset))
+          return nullptr;
+        Info.Kind = Tok.getKind();
+        Info.Flags = Tok.getFlags();
+        Info.Length = Tok.getLength();
+        if (const IdentifierInfo *II = Tok.getIdentifierInfo())
+          Info.Identifier = II->getName();
+        Def.Tokens.push_back(std::move(Info));
+      }
+      Result->Definitions.push_back(std::move(Def));
+      break;
+    }
+  }
+
+  std::sort(Result->Definitions.begin(), Result->Definitions.end(),
+            [](const PreparsedMacros::Definition &LHS,
+               const PreparsedMacros::Definition &RHS) {
+              return LHS.DefinitionOffset < RHS.DefinitionOffset;
+            });
+  return Result;
+}
+
+void Preprocessor::installPreparsedPredefines(const PreparsedMacros &Macros) {
+  FileID FID = getPredefinesFileID();
+  SourceLocation Start = SourceMgr.getLocForStartOfFile(FID);
+  const char *Buffer = SourceMgr.getBufferData(FID).data();
+
+  // Do what lexing the leading '# 1 "<built-in>" 3' line marker would do.
+  SourceMgr.AddLineNote(Start.getLocWithOffset(2), 1,
+                        SourceMgr.getLineTableFilenameID("<built-in>"),
+                        /*IsFileEntry=*/false, /*IsFileExit=*/false,
+                        /*IsSystemHeader=*/true, /*IsExternCHeader=*/false);
+  if (Callbacks)
+    Callbacks->FileChanged(
+        Start.getLocWithOffset(llvm::array_lengthof(BuiltinLineMarker) - 1),
+        PPCallbacks::RenameFile, SrcMgr::C_System);
+
+  for (const PreparsedMacros::Definition &Def : Macros.Definitions) {
+    IdentifierInfo *II = getIdentifierInfo(Def.Name);
+    MacroInfo *MI = AllocateMacroInfo(Start.getLocWithOffset(
+                                          Def.DefinitionOffset));
+    if (Def.IsFunctionLike) {
+      MI->setIsFunctionLike();
+      SmallVector<IdentifierInfo *, 8> Arguments;
+      for (const std::string &Arg : Def.Arguments)
+        Arguments.push_back(getIdentifierInfo(Arg));
+      MI->setArgumentList(Arguments, BP);
+    }
+    if (Def.IsC99Varargs)
+      MI->setIsC99Varargs();
+    if (Def.IsGNUVarargs)
+      MI->setIsGNUVarargs();
+    if (Def.HasCommaPasting)
+      MI->setHasCommaPasting();
+
+    for (const PreparsedMacros::TokenInfo &Info : Def.Tokens) {
+      Token Tok;
+      Tok.startToken();
+      Tok.setKind(Info.Kind);
+      Tok.setLocation(Start.getLocWithOffset(Info.Offset));
+      Tok.setLength(Info.Length);
+      for (unsigned Flag = 1; Flag <= Info.Flags; Flag <<= 1)
+        if (Info.Flags & Flag)
+          Tok.setFlag(Token::TokenFlags(Flag));
+      if (!Info.Identifier.empty()) {
+        // Whether an identifier is a keyword depends on the language options,
+        // so look it up again just like the lexer would.
+        IdentifierInfo *TokII = getIdentifierInfo(Info.Identifier);
+        Tok.setIdentifierInfo(TokII);
+        Tok.setKind(TokII->getTokenID());
+      } else if (Tok.isLiteral()) {
+        Tok.setLiteralData(Buffer + Info.Offset);
+      }
+      MI->AddTokenToBody(Tok);
+    }
+    MI->setDefinitionEndLoc(Start.getLocWithOffset(Def.DefinitionEndOffset));
+
+    ++NumDirectives;
+    ++NumDefined;
+    DefMacroDirective *MD = appendDefMacroDirective(II, MI);
+
+    if (Callbacks) {
+      Token MacroNameTok;
+      MacroNameTok.startToken();
+      MacroNameTok.setKind(II->getTokenID());
+      MacroNameTok.setIdentifierInfo(II);
+      MacroNameTok.setLocation(MI->getDefinitionLoc());
+      MacroNameTok.setLength(Def.Name.size());
+      Callbacks->MacroDefined(MacroNameTok, MD);
+    }
+  }
+
+  // Continue lexing after the predefined macros.
+  CurLexer->SkipBytes(Macros.PrefixSize, /*StartOfLine=*/true);
+}
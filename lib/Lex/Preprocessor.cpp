@@ -40,6 +40,7 @@
 #include "clang/Lex/ModuleLoader.h"
 #include "clang/Lex/PTHManager.h"
 #include "clang/Lex/Pragma.h"
+#include "clang/Lex/PredefinesCache.h"
 #include "clang/Lex/PreprocessingRecord.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Lex/ScratchBuffer.h"
@@ -77,8 +78,9 @@ Preprocessor::Preprocessor(IntrusiveRefCntPtr<PreprocessorOptions> PPOpts,
       CodeCompletionReached(0), CodeCompletionII(0), MainFileDir(nullptr),
       SkipMainFilePreamble(0, true), CurPPLexer(nullptr), CurDirLookup(nullptr),
       CurLexerKind(CLK_Lexer), CurSubmodule(nullptr), Callbacks(nullptr),
-      CurSubmoduleState(&NullSubmoduleState), MacroArgCache(nullptr),
-      Record(nullptr), MIChainHead(nullptr), DeserialMIChainHead(nullptr) {
+      HasTokenWatcher(false), CurSubmoduleState(&NullSubmoduleState),
+      MacroArgCache(nullptr), CacheablePredefinesSize(0), Record(nullptr),
+      MIChainHead(nullptr), DeserialMIChainHead(nullptr) {
   OwnsHeaderSearch = OwnsHeaders;
   
   CounterValue = 0; // __COUNTER__ starts at 0.
@@ -89,6 +91,8 @@ Preprocessor::Preprocessor(IntrusiveRefCntPtr<PreprocessorOptions> PPOpts,
   NumEnteredSourceFiles = 0;
   NumMacroExpanded = NumFnMacroExpanded = NumBuiltinMacroExpanded = 0;
   NumFastMacroExpanded = NumTokenPaste = NumFastTokenPaste = 0;
+  NumEmptyMacroExpanded = NumArgFreeFnMacroExpanded = 0;
+  NumPreExpandedArgs = NumReplayedPreExpandedArgs = 0;
   MaxIncludeStackDepth = 0;
   NumSkipped = 0;
   
@@ -102,12 +106,14 @@ Preprocessor::Preprocessor(IntrusiveRefCntPtr<PreprocessorOptions> PPOpts,
   MacroExpansionInDirectivesOverride = false;
   InMacroArgs = false;
   InMacroArgPreExpansion = false;
+  MacroStateGeneration = PreExpandedArgsGeneration = 0;
+  CurMacroArgPreExpansion = nullptr;
   NumCachedTokenLexers = 0;
   PragmasEnabled = true;
   ParsingIfOrElifDirective = false;
   PreprocessedOutput = false;
 
-  CachedLexPos = 0;
+  TokenCacheGeneration = 0;
 
   // We haven't read anything from the external source.
   ReadMacrosFromExternalSource = false;
@@ -185,6 +191,7 @@ void Preprocessor::Initialize(const TargetInfo &Target,
 
   // Initialize information about built-ins.
   BuiltinInfo.InitializeTarget(Target, AuxTarget);
+  BuiltinInfo.enableLazyTargetBuiltins(Identifiers, LangOpts);
   HeaderInfo.setTarget(Target);
 }
 
@@ -261,10 +268,20 @@ void Preprocessor::PrintStats() {
   llvm::errs() << "  " << NumEndif << " #endif.\n";
   llvm::errs() << "  " << NumPragma << " #pragma.\n";
   llvm::errs() << NumSkipped << " #if/#ifndef#ifdef regions skipped\n";
+  llvm::errs() << (PreparsedPredefines ? PreparsedPredefines->Definitions.size()
+                                       : 0)
+               << " predefined macros installed from the predefines cache.\n";
 
   llvm::errs() << NumMacroExpanded << "/" << NumFnMacroExpanded << "/"
              << NumBuiltinMacroExpanded << " obj/fn/builtin macros expanded, "
              << NumFastMacroExpanded << " on the fast path.\n";
+  llvm::errs() << "  " << NumEmptyMacroExpanded << " expanded to nothing, "
+               << NumFastMacroExpanded - NumEmptyMacroExpanded
+               << " to a single token, " << NumArgFreeFnMacroExpanded
+               << " function-like without substituting arguments.\n";
+  llvm::errs() << NumPreExpandedArgs << " macro arguments pre-expanded, "
+               << NumReplayedPreExpandedArgs << " replayed from earlier "
+               << "identical arguments.\n";
   llvm::errs() << (NumFastTokenPaste+NumTokenPaste)
              << " token paste (##) operations performed, "
              << NumFastTokenPaste << " on the fast path.\n";
@@ -528,9 +545,28 @@ void Preprocessor::EnterMainSourceFile() {
 
   // Start parsing the predefines.
   EnterSourceFile(FID, nullptr, SourceLocation());
+
+  // If another compilation already parsed the same predefined macros, install
+  // them directly instead of lexing them again.
+  if (CacheablePredefinesSize && CurLexer) {
+    PreparsedPredefines = PredefinesCache::lookup(
+        StringRef(Predefines).substr(0, CacheablePredefinesSize));
+    if (PreparsedPredefines)
+      installPreparsedPredefines(*PreparsedPredefines);
+  }
 }
 
 void Preprocessor::EndSourceFile() {
+  // Share the predefined macros with later compilations in this process.
+  // Don't trust them if something went wrong along the way.
+  if (CacheablePredefinesSize && !PreparsedPredefines &&
+      !getDiagnostics().hasErrorOccurred()) {
+    if (auto Macros = collectPredefinedMacros(CacheablePredefinesSize))
+      PredefinesCache::insert(
+          StringRef(Predefines).substr(0, CacheablePredefinesSize),
+          std::move(Macros));
+  }
+
   // Notify the client that we reached the end of the source file.
   if (Callbacks)
     Callbacks->EndOfMainFile();
@@ -730,6 +766,9 @@ bool Preprocessor::HandleIdentifier(Token &Identifier) {
 void Preprocessor::Lex(Token &Result) {
   // We loop here until a lex function returns a token; this avoids recursion.
   bool ReturnedToken;
+  // Whether the token was returned by a nested call to Lex, or replayed from
+  // the backtracking cache, and so has already been reported to OnToken.
+  bool IsReportedToken = false;
   do {
     switch (CurLexerKind) {
     case CLK_Lexer:
@@ -744,14 +783,19 @@ void Preprocessor::Lex(Token &Result) {
     case CLK_CachingLexer:
       CachingLex(Result);
       ReturnedToken = true;
+      IsReportedToken = true;
       break;
     case CLK_LexAfterModuleImport:
       LexAfterModuleImport(Result);
       ReturnedToken = true;
+      IsReportedToken = true;
       break;
     }
   } while (!ReturnedToken);
 
+  if (HasTokenWatcher && !IsReportedToken)
+    OnToken(Result);
+
   if (Result.is(tok::code_completion))
     setCodeCompletionIdentifierInfo(Result.getIdentifierInfo());
 
@@ -827,6 +871,7 @@ void Preprocessor::LexAfterModuleImport(Token &Result) {
 }
 
 void Preprocessor::makeModuleVisible(Module *M, SourceLocation Loc) {
+  ++MacroStateGeneration;
   CurSubmoduleState->VisibleModules.setVisible(
       M, Loc, [](Module *) {},
       [&](ArrayRef<Module *> Path, Module *Conflict, StringRef Message) {
@@ -491,7 +491,49 @@ void Parser::ParseLexedMethodDefs(ParsingClass &Class) {
   }
 }
 
+/// \brief Whether the body of \p LM can be left unparsed until the method is
+/// used, in -fdelayed-inline-method-parsing mode.
+///
+/// The body is then parsed at the end of the translation unit, where name
+/// lookup finds declarations that follow the class, just like for
+/// -fdelayed-template-parsing. Bodies which are never used are never checked,
+/// so their errors go undiagnosed. Methods whose definition can be needed
+/// without being odr-used, or which have to be emitted anyway, are not
+/// delayed.
+bool Parser::canDelayLexedMethodDef(const LexedMethod &LM) {
+  if (!getLangOpts().DelayedInlineMethodParsing || LM.TemplateScope ||
+      Actions.TUKind != TU_Complete || PP.isCodeCompletionEnabled() ||
+      getLangOpts().EmitAllDecls)
+    return false;
+
+  // Friends and member templates are not delayed.
+  auto *MD = dyn_cast_or_null<CXXMethodDecl>(LM.D);
+  if (!MD || MD->isInvalidDecl() || MD->isDependentContext() ||
+      MD->getParent()->isLocalClass())
+    return false;
+
+  // Virtual functions are needed whenever the vtable is, constexpr functions
+  // and functions with deduced return types as soon as they are referenced.
+  if (MD->isVirtual() || MD->isConstexpr() ||
+      MD->getReturnType()->getContainedAutoType())
+    return false;
+
+  if (MD->hasAttr<UsedAttr>() || MD->hasAttr<DLLExportAttr>() ||
+      MD->getParent()->hasAttr<DLLExportAttr>())
+    return false;
+
+  // A default member initializer or default argument in the class may have
+  // used the method already.
+  return !MD->isUsed(/*CheckUsedAttr=*/false);
+}
+
 void Parser::ParseLexedMethodDef(LexedMethod &LM) {
+  if (canDelayLexedMethodDef(LM)) {
+    Actions.MarkAsLateParsedTemplate(LM.D->getAsFunction(), LM.D, LM.Toks);
+    ++NumDelayedInlineMethods;
+    return;
+  }
+
   // If this is a member template, introduce the template parameter scope.
   ParseScope TemplateScope(this, Scope::TemplateParamScope, LM.TemplateScope);
   TemplateParameterDepthRAII CurTemplateDepthTracker(TemplateParameterDepth);
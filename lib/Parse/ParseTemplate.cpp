@@ -1404,6 +1404,11 @@ void Parser::ParseLateTemplatedFuncDef(LateParsedTemplate &LPT) {
              "current template being instantiated!");
       ParseFunctionStatementBody(LPT.D, FnScope);
       Actions.UnmarkAsLateParsedTemplate(FunD);
+
+      // This was an inline method whose parsing was delayed until it was
+      // used; see canDelayLexedMethodDef(). Sema hands it to the consumer.
+      if (!FunD->isDependentContext() && isa<CXXMethodDecl>(FunD))
+        ++NumDelayedInlineMethodsParsed;
     } else
       Actions.ActOnFinishFunctionBody(LPT.D, nullptr);
   }
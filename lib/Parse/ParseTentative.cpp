@@ -133,10 +133,13 @@ bool Parser::isCXXSimpleDeclaration(bool AllowForRangeDecl) {
   // or an identifier which doesn't resolve as anything. We need tentative
   // parsing...
  
-  {
-    RevertingTentativeParsingAction PA(*this);
-    TPR = TryParseSimpleDeclaration(AllowForRangeDecl);
-  }
+  bool IsAmbiguous;
+  TPR = memoizeTentativeParse(
+      AllowForRangeDecl ? TPK_ForRangeDeclaration : TPK_SimpleDeclaration,
+      IsAmbiguous, [&](bool &) {
+        RevertingTentativeParsingAction PA(*this);
+        return TryParseSimpleDeclaration(AllowForRangeDecl);
+      });
 
   // In case of an error, let the declaration parsing code handle it.
   if (TPR == TPResult::Error)
@@ -507,39 +510,45 @@ bool Parser::isCXXTypeId(TentativeCXXTypeIdContext Context, bool &isAmbiguous) {
 
   // Ok, we have a simple-type-specifier/typename-specifier followed by a '('.
   // We need tentative parsing...
+  TPR = memoizeTentativeParse(TPK_TypeId + Context, isAmbiguous,
+                              [&](bool &TypeIdIsAmbiguous) {
+    RevertingTentativeParsingAction PA(*this);
 
-  RevertingTentativeParsingAction PA(*this);
-
-  // type-specifier-seq
-  TryConsumeDeclarationSpecifier();
-  assert(Tok.is(tok::l_paren) && "Expected '('");
-
-  // declarator
-  TPR = TryParseDeclarator(true/*mayBeAbstract*/, false/*mayHaveIdentifier*/);
-
-  // In case of an error, let the declaration parsing code handle it.
-  if (TPR == TPResult::Error)
-    TPR = TPResult::True;
-
-  if (TPR == TPResult::Ambiguous) {
-    // We are supposed to be inside parens, so if after the abstract declarator
-    // we encounter a ')' this is a type-id, otherwise it's an expression.
-    if (Context == TypeIdInParens && Tok.is(tok::r_paren)) {
-      TPR = TPResult::True;
-      isAmbiguous = true;
-
-    // We are supposed to be inside a template argument, so if after
-    // the abstract declarator we encounter a '>', '>>' (in C++0x), or
-    // ',', this is a type-id. Otherwise, it's an expression.
-    } else if (Context == TypeIdAsTemplateArgument &&
-               (Tok.isOneOf(tok::greater, tok::comma) ||
-                (getLangOpts().CPlusPlus11 && Tok.is(tok::greatergreater)))) {
-      TPR = TPResult::True;
-      isAmbiguous = true;
+    // type-specifier-seq
+    TryConsumeDeclarationSpecifier();
+    assert(Tok.is(tok::l_paren) && "Expected '('");
 
-    } else
-      TPR = TPResult::False;
-  }
+    // declarator
+    TPResult Result =
+        TryParseDeclarator(true/*mayBeAbstract*/, false/*mayHaveIdentifier*/);
+
+    // In case of an error, let the declaration parsing code handle it.
+    if (Result == TPResult::Error)
+      Result = TPResult::True;
+
+    if (Result == TPResult::Ambiguous) {
+      // We are supposed to be inside parens, so if after the abstract
+      // declarator we encounter a ')' this is a type-id, otherwise it's an
+      // expression.
+      if (Context == TypeIdInParens && Tok.is(tok::r_paren)) {
+        Result = TPResult::True;
+        TypeIdIsAmbiguous = true;
+
+      // We are supposed to be inside a template argument, so if after
+      // the abstract declarator we encounter a '>', '>>' (in C++0x), or
+      // ',', this is a type-id. Otherwise, it's an expression.
+      } else if (Context == TypeIdAsTemplateArgument &&
+                 (Tok.isOneOf(tok::greater, tok::comma) ||
+                  (getLangOpts().CPlusPlus11 &&
+                   Tok.is(tok::greatergreater)))) {
+        Result = TPResult::True;
+        TypeIdIsAmbiguous = true;
+
+      } else
+        Result = TPResult::False;
+    }
+    return Result;
+  });
 
   assert(TPR == TPResult::True || TPR == TPResult::False);
   return TPR == TPResult::True;
@@ -1082,6 +1091,49 @@ bool Parser::isTentativelyDeclared(IdentifierInfo *II) {
       != TentativelyDeclaredIdentifiers.end();
 }
 
+Parser::TPResult Parser::memoizeTentativeParse(
+    unsigned Kind, bool &IsAmbiguous,
+    llvm::function_ref<TPResult(bool &)> Disambiguate) {
+  ++NumTentativeParses;
+  IsAmbiguous = false;
+
+  // Outcomes are only reused while the tokens they were computed from are
+  // cached; once the cache has been drained, the same tokens can't come back.
+  if (TentativeParseCacheGeneration != PP.getTokenCacheGeneration()) {
+    TentativeParseCache.clear();
+    TentativeParseCacheGeneration = PP.getTokenCacheGeneration();
+  }
+  bool TokensCached =
+      PP.isBacktrackEnabled() || PP.getNumCachedTokensAhead() != 0;
+  std::pair<unsigned, unsigned> Key(Kind, Tok.getLocation().getRawEncoding());
+
+  if (TokensCached) {
+    auto Known = TentativeParseCache.find(Key);
+    if (Known != TentativeParseCache.end()) {
+      ++NumTentativeParseCacheHits;
+      NumTokensNotRescanned += Known->second.TokensScanned;
+      IsAmbiguous = Known->second.IsAmbiguous;
+      return Known->second.Result;
+    }
+  }
+
+  unsigned AheadBefore = PP.getNumCachedTokensAhead();
+  TPResult Result = Disambiguate(IsAmbiguous);
+  unsigned AheadAfter = PP.getNumCachedTokensAhead();
+
+  // The disambiguation always backtracks, so everything it looked at is now
+  // cached ahead of the current token.
+  if (PP.getTokenCacheGeneration() == TentativeParseCacheGeneration) {
+    TentativeParseOutcome Outcome;
+    Outcome.Result = Result;
+    Outcome.IsAmbiguous = IsAmbiguous;
+    Outcome.TokensScanned =
+        AheadAfter > AheadBefore ? AheadAfter - AheadBefore : 0;
+    TentativeParseCache[Key] = Outcome;
+  }
+  return Result;
+}
+
 namespace {
 class TentativeParseCCC : public CorrectionCandidateCallback {
 public:
@@ -1672,29 +1724,35 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
   // ambiguities mentioned in 6.8, the resolution is to consider any construct
   // that could possibly be a declaration a declaration.
 
-  RevertingTentativeParsingAction PA(*this);
+  bool Ambiguous;
+  TPResult TPR = memoizeTentativeParse(TPK_FunctionDeclarator, Ambiguous,
+                                       [&](bool &) {
+    RevertingTentativeParsingAction PA(*this);
 
-  ConsumeParen();
-  bool InvalidAsDeclaration = false;
-  TPResult TPR = TryParseParameterDeclarationClause(&InvalidAsDeclaration);
-  if (TPR == TPResult::Ambiguous) {
-    if (Tok.isNot(tok::r_paren))
-      TPR = TPResult::False;
-    else {
-      const Token &Next = NextToken();
-      if (Next.isOneOf(tok::amp, tok::ampamp, tok::kw_const, tok::kw_volatile,
-                       tok::kw_throw, tok::kw_noexcept, tok::l_square,
-                       tok::l_brace, tok::kw_try, tok::equal, tok::arrow) ||
-          isCXX11VirtSpecifier(Next))
-        // The next token cannot appear after a constructor-style initializer,
-        // and can appear next in a function definition. This must be a function
-        // declarator.
-        TPR = TPResult::True;
-      else if (InvalidAsDeclaration)
-        // Use the absence of 'typename' as a tie-breaker.
+    ConsumeParen();
+    bool InvalidAsDeclaration = false;
+    TPResult TPR = TryParseParameterDeclarationClause(&InvalidAsDeclaration);
+    if (TPR == TPResult::Ambiguous) {
+      if (Tok.isNot(tok::r_paren))
         TPR = TPResult::False;
+      else {
+        const Token &Next = NextToken();
+        if (Next.isOneOf(tok::amp, tok::ampamp, tok::kw_const,
+                         tok::kw_volatile, tok::kw_throw, tok::kw_noexcept,
+                         tok::l_square, tok::l_brace, tok::kw_try, tok::equal,
+                         tok::arrow) ||
+            isCXX11VirtSpecifier(Next))
+          // The next token cannot appear after a constructor-style
+          // initializer, and can appear next in a function definition. This
+          // must be a function declarator.
+          TPR = TPResult::True;
+        else if (InvalidAsDeclaration)
+          // Use the absence of 'typename' as a tie-breaker.
+          TPR = TPResult::False;
+      }
     }
-  }
+    return TPR;
+  });
 
   if (IsAmbiguous && TPR == TPResult::Ambiguous)
     *IsAmbiguous = true;
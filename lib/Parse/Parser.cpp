@@ -20,6 +20,7 @@
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/ParsedTemplate.h"
 #include "clang/Sema/Scope.h"
+#include "llvm/Support/Format.h"
 using namespace clang;
 
 
@@ -77,8 +78,12 @@ Parser::Parser(Preprocessor &pp, Sema &actions, bool skipFunctionBodies)
   Tok.setKind(tok::eof);
   Actions.CurScope = nullptr;
   NumCachedScopes = 0;
+  NumScopesAllocated = NumScopesReused = NumTopLevelDecls = 0;
   ParenCount = BracketCount = BraceCount = 0;
   CurParsedObjCImpl = nullptr;
+  TentativeParseCacheGeneration = PP.getTokenCacheGeneration();
+  NumTentativeParses = NumTentativeParseCacheHits = NumTokensNotRescanned = 0;
+  NumDelayedInlineMethods = NumDelayedInlineMethodsParsed = 0;
 
   // Add #pragma handlers. These are removed and destroyed in the
   // destructor.
@@ -98,6 +103,29 @@ DiagnosticBuilder Parser::Diag(const Token &Tok, unsigned DiagID) {
   return Diag(Tok.getLocation(), DiagID);
 }
 
+void Parser::PrintStats() const {
+  llvm::errs() << "\n*** Parser Stats:\n";
+  llvm::errs() << "  " << NumTentativeParses
+               << " disambiguating tentative parses, "
+               << NumTentativeParseCacheHits << " reused from the cache.\n";
+  llvm::errs() << "  " << NumTokensNotRescanned
+               << " tokens not re-scanned thanks to the cache.\n";
+  llvm::errs() << "  " << NumTopLevelDecls << " top-level declarations, "
+               << NumScopesAllocated << " scopes and "
+               << Actions.NumFunctionScopesAllocated
+               << " function scopes allocated ("
+               << llvm::format("%.2f",
+                               double(NumScopesAllocated +
+                                      Actions.NumFunctionScopesAllocated) /
+                                   std::max(NumTopLevelDecls, 1u))
+               << " per declaration), " << NumScopesReused << " scopes and "
+               << Actions.NumFunctionScopesReused
+               << " function scopes reused.\n";
+  llvm::errs() << "  " << NumDelayedInlineMethods
+               << " inline method bodies delayed, "
+               << NumDelayedInlineMethodsParsed << " parsed when used.\n";
+}
+
 /// \brief Emits a diagnostic suggesting parentheses surrounding a
 /// given range.
 ///
@@ -374,8 +402,10 @@ void Parser::EnterScope(unsigned ScopeFlags) {
     Scope *N = ScopeCache[--NumCachedScopes];
     N->Init(getCurScope(), ScopeFlags);
     Actions.CurScope = N;
+    ++NumScopesReused;
   } else {
     Actions.CurScope = new Scope(getCurScope(), ScopeFlags, Diags);
+    ++NumScopesAllocated;
   }
 }
 
@@ -572,6 +602,8 @@ bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
     ConsumeToken();
 
   Result = nullptr;
+  if (Tok.isNot(tok::eof))
+    ++NumTopLevelDecls;
   switch (Tok.getKind()) {
   case tok::annot_pragma_unused:
     HandlePragmaUnused();
@@ -602,7 +634,8 @@ bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
 
   case tok::eof:
     // Late template parsing can begin.
-    if (getLangOpts().DelayedTemplateParsing)
+    if (getLangOpts().DelayedTemplateParsing ||
+        getLangOpts().DelayedInlineMethodParsing)
       Actions.SetLateTemplateParser(LateTemplateParserCallback,
                                     PP.isIncrementalProcessingEnabled() ?
                                     LateTemplateParserCleanupCallback : nullptr,
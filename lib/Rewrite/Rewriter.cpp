@@ -20,6 +20,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 using namespace clang;
 
 raw_ostream &RewriteBuffer::write(raw_ostream &os) const {
@@ -114,6 +115,124 @@ void RewriteBuffer::ReplaceText(unsigned OrigOffset, unsigned OrigLength,
     AddReplaceDelta(OrigOffset, NewStr.size() - OrigLength);
 }
 
+namespace {
+/// Copies the text of a rewrite rope from front to back, one piece at a time.
+class RopeCopier {
+  RewriteBuffer::iterator I;
+  StringRef Piece;
+  unsigned Offset;
+
+public:
+  explicit RopeCopier(RewriteBuffer::iterator Begin) : I(Begin), Offset(0) {}
+
+  unsigned getOffset() const { return Offset; }
+
+  /// Append the text up to \p End to \p Out, or drop it if \p Out is null.
+  void copyTo(unsigned End, std::string *Out) {
+    while (Offset < End) {
+      if (Piece.empty()) {
+        Piece = I.piece();
+        I.MoveToNextPiece();
+      }
+      size_t Size = std::min<size_t>(Piece.size(), End - Offset);
+      if (Out)
+        Out->append(Piece.data(), Size);
+      Piece = Piece.drop_front(Size);
+      Offset += Size;
+    }
+  }
+};
+} // end anonymous namespace
+
+bool RewriteBuffer::applyEdits(ArrayRef<Edit> Edits) {
+  SmallVector<const Edit *, 64> Sorted;
+  size_t NewSize = Buffer.size();
+  for (const Edit &E : Edits) {
+    Sorted.push_back(&E);
+    NewSize += E.Text.size();
+  }
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const Edit *LHS, const Edit *RHS) {
+                     return LHS->OrigOffset < RHS->OrigOffset;
+                   });
+
+  // Reject the whole batch if a replaced range overlaps another one, or has
+  // text inserted inside it. Insertions at either end are fine.
+  unsigned ReplacedBegin = 0, ReplacedEnd = 0;
+  for (const Edit *E : Sorted) {
+    if (E->OrigOffset < ReplacedEnd &&
+        (E->OrigLength || E->OrigOffset != ReplacedBegin))
+      return true;
+    if (E->OrigLength) {
+      ReplacedBegin = E->OrigOffset;
+      ReplacedEnd = E->OrigOffset + E->OrigLength;
+    }
+  }
+
+  // Rebuilding the buffer costs about as much as a few edits per page of
+  // text; make small batches one edit at a time.
+  if (Edits.size() * 4096 < Buffer.size()) {
+    for (const Edit &E : Edits) {
+      if (E.OrigLength)
+        ReplaceText(E.OrigOffset, E.OrigLength, E.Text);
+      else
+        InsertText(E.OrigOffset, E.Text, E.InsertAfter);
+    }
+    return false;
+  }
+
+  std::string Result;
+  Result.reserve(NewSize);
+  RopeCopier Copier(begin());
+  for (unsigned I = 0, N = Sorted.size(); I != N;) {
+    unsigned OrigOffset = Sorted[I]->OrigOffset;
+    unsigned End = I;
+    while (End != N && Sorted[End]->OrigOffset == OrigOffset)
+      ++End;
+
+    // At each position, the text inserted before earlier insertions comes
+    // first (the last edit first), then the text inserted earlier, then the
+    // text inserted after it (the first edit first), then the replacement.
+    unsigned InsertsBegin = getMappedOffset(OrigOffset);
+    unsigned InsertsEnd = getMappedOffset(OrigOffset, true);
+    assert(InsertsBegin >= Copier.getOffset() && "Edits overlap");
+    Copier.copyTo(InsertsBegin, &Result);
+    for (unsigned J = End; J != I; --J)
+      if (!Sorted[J - 1]->OrigLength && !Sorted[J - 1]->InsertAfter)
+        Result += Sorted[J - 1]->Text;
+    Copier.copyTo(InsertsEnd, &Result);
+    const Edit *Replacement = nullptr;
+    for (unsigned J = I; J != End; ++J) {
+      if (!Sorted[J]->OrigLength) {
+        if (Sorted[J]->InsertAfter)
+          Result += Sorted[J]->Text;
+        continue;
+      }
+      assert(!Replacement && "Overlapping edits");
+      Replacement = Sorted[J];
+    }
+    if (Replacement) {
+      assert(InsertsEnd + Replacement->OrigLength <= Buffer.size() &&
+             "Invalid location");
+      Result += Replacement->Text;
+      Copier.copyTo(InsertsEnd + Replacement->OrigLength, nullptr);
+    }
+    I = End;
+  }
+  Copier.copyTo(Buffer.size(), &Result);
+
+  // Record the same deltas as making the edits one at a time would.
+  for (const Edit *E : Sorted) {
+    if (!E->OrigLength) {
+      if (!E->Text.empty())
+        AddInsertDelta(E->OrigOffset, E->Text.size());
+    } else if (E->OrigLength != E->Text.size()) {
+      AddReplaceDelta(E->OrigOffset, E->Text.size() - E->OrigLength);
+    }
+  }
+  Buffer.assign(Result.data(), Result.data() + Result.size());
+  return false;
+}
 
 //===----------------------------------------------------------------------===//
 // Rewriter class
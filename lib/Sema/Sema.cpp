@@ -127,6 +127,8 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
                                 false);
 
   FunctionScopes.push_back(new FunctionScopeInfo(Diags));
+  NumFunctionScopesAllocated = 1;
+  NumFunctionScopesReused = 0;
 
   // Initilization of data sharing attributes stack for OpenMP
   InitDataSharingAttributesStack();
@@ -266,6 +268,7 @@ Sema::~Sema() {
     delete FunctionScopes[I];
   if (FunctionScopes.size() == 1)
     delete FunctionScopes[0];
+  llvm::DeleteContainerPointers(CachedFunctionScopes);
 
   // Tell the SemaConsumer to forget about us; we're going out of scope.
   if (SemaConsumer *SC = dyn_cast<SemaConsumer>(&Consumer))
@@ -571,7 +574,11 @@ static bool MethodsAndNestedClassesComplete(const CXXRecordDecl *RD,
                                   E = RD->decls_end();
        I != E && Complete; ++I) {
     if (const CXXMethodDecl *M = dyn_cast<CXXMethodDecl>(*I))
-      Complete = M->isDefined() || (M->isPure() && !isa<CXXDestructorDecl>(M));
+      // An inline method that is still marked as late parsed was never used
+      // (-fdelayed-inline-method-parsing), so its body was never analyzed.
+      Complete = !M->isLateTemplateParsed() &&
+                 (M->isDefined() ||
+                  (M->isPure() && !isa<CXXDestructorDecl>(M)));
     else if (const FunctionTemplateDecl *F = dyn_cast<FunctionTemplateDecl>(*I))
       // If the template function is marked as late template parsed at this
       // point, it has not been instantiated and therefore we have not
@@ -684,6 +691,13 @@ void Sema::ActOnEndOfTranslationUnit() {
     }
     PerformPendingInstantiations();
 
+    // Parse the delayed inline member functions which turned out to be used.
+    // Their bodies can use more vtables, templates and delayed functions.
+    while (ParsePendingDelayedInlineMethods()) {
+      DefineUsedVTables();
+      PerformPendingInstantiations();
+    }
+
     if (LateTemplateParserCleanup)
       LateTemplateParserCleanup(OpaqueParser);
 
@@ -1045,6 +1059,10 @@ void Sema::EmitCurrentDiagnostic(unsigned DiagID) {
   if (!Diags.EmitCurrentDiagnostic())
     return;
 
+  // Nobody would see the instantiation backtrace.
+  if (!Diags.getClient()->needsNotes())
+    return;
+
   // If this is not a note, and we're in a template instantiation
   // that is different from the last template instantiation where
   // we emitted an error, print a template instantiation
@@ -1123,18 +1141,31 @@ void Sema::PushFunctionScope() {
     // memory for a new scope.
     FunctionScopes.back()->Clear();
     FunctionScopes.push_back(FunctionScopes.back());
+    ++NumFunctionScopesReused;
+    return;
+  }
+
+  // Otherwise, reuse the scope of an earlier nested function.
+  if (!CachedFunctionScopes.empty()) {
+    FunctionScopeInfo *FSI = CachedFunctionScopes.pop_back_val();
+    FSI->Clear();
+    FunctionScopes.push_back(FSI);
+    ++NumFunctionScopesReused;
     return;
   }
 
+  ++NumFunctionScopesAllocated;
   FunctionScopes.push_back(new FunctionScopeInfo(getDiagnostics()));
 }
 
 void Sema::PushBlockScope(Scope *BlockScope, BlockDecl *Block) {
+  ++NumFunctionScopesAllocated;
   FunctionScopes.push_back(new BlockScopeInfo(getDiagnostics(),
                                               BlockScope, Block));
 }
 
 LambdaScopeInfo *Sema::PushLambdaScope() {
+  ++NumFunctionScopesAllocated;
   LambdaScopeInfo *const LSI = new LambdaScopeInfo(getDiagnostics());
   FunctionScopes.push_back(LSI);
   return LSI;
@@ -1161,7 +1192,15 @@ void Sema::PopFunctionScopeInfo(const AnalysisBasedWarnings::Policy *WP,
     for (const auto &PUD : Scope->PossiblyUnreachableDiags)
       Diag(PUD.Loc, PUD.PD);
 
-  if (FunctionScopes.back() != Scope)
+  if (FunctionScopes.back() == Scope)
+    return;
+
+  // Keep the scopes of nested functions for reuse. Blocks, lambdas and
+  // captured regions carry their own state and are not reused.
+  if (!isa<CapturingScopeInfo>(Scope) &&
+      CachedFunctionScopes.size() < MaxCachedFunctionScopes)
+    CachedFunctionScopes.push_back(Scope);
+  else
     delete Scope;
 }
 
@@ -1501,6 +1540,7 @@ IdentifierInfo *Sema::getFloat128Identifier() const {
 
 void Sema::PushCapturedRegionScope(Scope *S, CapturedDecl *CD, RecordDecl *RD,
                                    CapturedRegionKind K) {
+  ++NumFunctionScopesAllocated;
   CapturingScopeInfo *CSI = new CapturedRegionScopeInfo(
       getDiagnostics(), S, CD, RD, CD->getContextParam(), K,
       (getLangOpts().OpenMP && K == CR_OpenMP) ? getOpenMPNestingLevel() : 0);
@@ -13226,6 +13226,11 @@ void Sema::MarkFunctionReferenced(SourceLocation Loc, FunctionDecl *Func,
 
   if (!OdrUse) return;
 
+  // Inline member functions whose parsing was delayed are parsed once used.
+  if (LangOpts.DelayedInlineMethodParsing && Func->isLateTemplateParsed() &&
+      !Func->isDependentContext())
+    PendingDelayedInlineMethods.push_back(Func);
+
   // Keep track of used but undefined functions.
   if (!Func->isDefined()) {
     if (mightHaveNonExternalLinkage(Func))
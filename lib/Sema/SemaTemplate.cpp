@@ -8666,6 +8666,36 @@ void Sema::UnmarkAsLateParsedTemplate(FunctionDecl *FD) {
   FD->setLateTemplateParsed(false);
 }
 
+/// \brief Parse the bodies of the delayed inline member functions which have
+/// been used. Returns false if there were none.
+bool Sema::ParsePendingDelayedInlineMethods() {
+  if (PendingDelayedInlineMethods.empty() || !LateTemplateParser)
+    return false;
+
+  while (!PendingDelayedInlineMethods.empty()) {
+    FunctionDecl *FD = PendingDelayedInlineMethods.pop_back_val();
+    if (!FD->isLateTemplateParsed())
+      continue;
+    if (FD->isFromASTFile())
+      ExternalSource->ReadLateParsedTemplates(LateParsedTemplateMap);
+    // Friends are only marked as late parsed while their class is parsed.
+    LateParsedTemplate *LPT = LateParsedTemplateMap.lookup(FD);
+    if (!LPT)
+      continue;
+    LateTemplateParser(OpaqueParser, *LPT);
+
+    // A function-try-block is not unmarked by the parser; never parse the
+    // body twice.
+    if (FD->isLateTemplateParsed())
+      UnmarkAsLateParsedTemplate(FD);
+
+    // The consumer has already seen the rest of the translation unit, so
+    // hand the definition over the way instantiated functions are.
+    Consumer.HandleTopLevelDecl(DeclGroupRef(FD));
+  }
+  return true;
+}
+
 bool Sema::IsInsideALocalClassWithinATemplateFunction() {
   DeclContext *DC = CurContext;
 
@@ -1291,6 +1291,24 @@ bool ASTReader::ReadSLocEntry(int ID) {
                                                              NumFileDecls));
     }
 
+    // Use the line table computed when the AST file was written, if there is
+    // one and the file is still the same.
+    uint64_t LineTablePos = SLocEntryCursor.GetCurrentBitNo();
+    llvm::BitstreamEntry LineTableEntry = SLocEntryCursor.advance();
+    RecordData LineTableRecord;
+    StringRef LineTableBlob;
+    if (LineTableEntry.Kind == llvm::BitstreamEntry::Record &&
+        SLocEntryCursor.readRecord(LineTableEntry.ID, LineTableRecord,
+                                   &LineTableBlob) == SM_SLOC_LINE_TABLE) {
+      if (!IF.isOutOfDate() && !OverriddenBuffer)
+        SourceMgr.setPrecomputedLineOffsets(
+            FID, llvm::makeArrayRef(
+                     reinterpret_cast<const unsigned *>(LineTableBlob.data()),
+                     LineTableBlob.size() / sizeof(unsigned)));
+    } else {
+      SLocEntryCursor.JumpToBit(LineTablePos);
+    }
+
     const SrcMgr::ContentCache *ContentCache
       = SourceMgr.getOrCreateContentCache(File,
                               /*isSystemFile=*/FileCharacter != SrcMgr::C_User);
@@ -2850,6 +2868,19 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       break;
     }
 
+    case SOURCE_LOCATION_STARTS: {
+      // Tell the source manager where the entries start, so that it can
+      // search them without loading them.
+      if (!F.SLocEntryBaseID ||
+          Blob.size() != F.LocalNumSLocEntries * sizeof(uint32_t))
+        break;
+      const uint32_t *Starts = (const uint32_t *)Blob.data();
+      for (unsigned I = 0; I != F.LocalNumSLocEntries; ++I)
+        SourceMgr.setLoadedSLocEntryOffset(F.SLocEntryBaseID + I,
+                                           F.SLocEntryBaseOffset + Starts[I]);
+      break;
+    }
+
     case MODULE_OFFSET_MAP: {
       // Additional remapping information.
       const unsigned char *Data = (const unsigned char*)Blob.data();
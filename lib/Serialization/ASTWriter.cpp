@@ -980,6 +980,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(OPTIMIZE_PRAGMA_OPTIONS);
   RECORD(MSSTRUCT_PRAGMA_OPTIONS);
   RECORD(POINTERS_TO_MEMBERS_PRAGMA_OPTIONS);
+  RECORD(SOURCE_LOCATION_STARTS);
   RECORD(UNUSED_LOCAL_TYPEDEF_NAME_CANDIDATES);
   RECORD(DELETE_EXPRS_TO_ANALYZE);
 
@@ -990,6 +991,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(SM_SLOC_BUFFER_BLOB);
   RECORD(SM_SLOC_BUFFER_BLOB_COMPRESSED);
   RECORD(SM_SLOC_EXPANSION_ENTRY);
+  RECORD(SM_SLOC_LINE_TABLE);
 
   // Preprocessor Block.
   BLOCK(PREPROCESSOR_BLOCK);
@@ -1685,6 +1687,17 @@ static unsigned CreateSLocBufferBlobAbbrev(llvm::BitstreamWriter &Stream,
   return Stream.EmitAbbrev(Abbrev);
 }
 
+/// \brief Create an abbreviation for the SLocEntry that refers to the
+/// line table of a file.
+static unsigned CreateSLocLineTableAbbrev(llvm::BitstreamWriter &Stream) {
+  using namespace llvm;
+
+  auto *Abbrev = new BitCodeAbbrev();
+  Abbrev->Add(BitCodeAbbrevOp(SM_SLOC_LINE_TABLE));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // Line offsets
+  return Stream.EmitAbbrev(Abbrev);
+}
+
 /// \brief Create an abbreviation for the SLocEntry that refers to a macro
 /// expansion.
 static unsigned CreateSLocExpansionAbbrev(llvm::BitstreamWriter &Stream) {
@@ -1911,12 +1924,15 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
   unsigned SLocBufferBlobCompressedAbbrv =
       CreateSLocBufferBlobAbbrev(Stream, true);
   unsigned SLocExpansionAbbrv = CreateSLocExpansionAbbrev(Stream);
+  unsigned SLocLineTableAbbrv = CreateSLocLineTableAbbrev(Stream);
 
   // Write out the source location entry table. We skip the first
   // entry, which is always the same dummy entry.
   std::vector<uint32_t> SLocEntryOffsets;
+  std::vector<uint32_t> SLocEntryStarts;
   RecordData PreloadSLocs;
   SLocEntryOffsets.reserve(SourceMgr.local_sloc_entry_size() - 1);
+  SLocEntryStarts.reserve(SourceMgr.local_sloc_entry_size() - 1);
   for (unsigned I = 1, N = SourceMgr.local_sloc_entry_size();
        I != N; ++I) {
     // Get this source location entry.
@@ -1942,6 +1958,7 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
 
     // Starting offset of this entry within this module, so skip the dummy.
     Record.push_back(SLoc->getOffset() - 2);
+    SLocEntryStarts.push_back(SLoc->getOffset() - 2);
     if (SLoc->isFile()) {
       const SrcMgr::FileInfo &File = SLoc->getFile();
       AddSourceLocation(File.getIncludeLoc(), Record);
@@ -1970,6 +1987,17 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
         }
         
         Stream.EmitRecordWithAbbrev(SLocFileAbbrv, Record);
+
+        // Store the line table, so that readers don't have to scan the file
+        // again to find lines.
+        ArrayRef<unsigned> LineOffsets = SourceMgr.getLineOffsets(FID);
+        if (!LineOffsets.empty()) {
+          RecordData::value_type Record[] = {SM_SLOC_LINE_TABLE};
+          Stream.EmitRecordWithBlob(
+              SLocLineTableAbbrv, Record,
+              StringRef(reinterpret_cast<const char *>(LineOffsets.data()),
+                        LineOffsets.size() * sizeof(unsigned)));
+        }
         
         if (Content->BufferOverridden || Content->IsTransient)
           EmitBlob = true;
@@ -2054,6 +2082,18 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
     Stream.EmitRecordWithBlob(SLocOffsetsAbbrev, Record,
                               bytes(SLocEntryOffsets));
   }
+
+  // Write the starting offsets of the entries, so that the reader can find
+  // the entry containing a location without loading the entries.
+  Abbrev = new BitCodeAbbrev();
+  Abbrev->Add(BitCodeAbbrevOp(SOURCE_LOCATION_STARTS));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // starts
+  unsigned SLocStartsAbbrev = Stream.EmitAbbrev(Abbrev);
+  {
+    RecordData::value_type Record[] = {SOURCE_LOCATION_STARTS};
+    Stream.EmitRecordWithBlob(SLocStartsAbbrev, Record,
+                              bytes(SLocEntryStarts));
+  }
   // Write the source location entry preloads array, telling the AST
   // reader which source locations entries it should load eagerly.
   Stream.EmitRecord(SOURCE_LOCATION_PRELOADS, PreloadSLocs);
@@ -0,0 +1,12 @@
+@interface NSObject
+@end
+
+@interface Holder : NSObject {
+  Target *target;
+}
+@property (assign) Target *target;
+@end
+
+@implementation Holder
+@synthesize target;
+@end
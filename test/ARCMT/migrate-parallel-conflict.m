@@ -0,0 +1,9 @@
+// RUN: rm -rf %t
+// RUN: not arcmt-test -jobs=2 -migrate-directory %t --args -triple x86_64-apple-macosx10.7 -x objective-c %S/Inputs/conflict1.m.in %S/Inputs/conflict2.m.in 2>&1 | FileCheck %s
+// RUN: rm -rf %t
+
+// Both files change the same lines of the shared conflict.h: the first makes
+// 'target' weak, the second, whose Target opts out of weak references, makes
+// it unsafe_unretained.
+// CHECK: error: migrating '{{.*}}conflict2.m.in' changes '{{.*}}conflict.h' in a way that conflicts with the migration of other files
+// CHECK-NOT: error:
@@ -0,0 +1,6 @@
+// RUN: rm -rf %t
+// RUN: arcmt-test -jobs=2 -migrate-directory %t --args -x objective-c %S/Inputs/test1.m.in %S/Inputs/test2.m.in
+// RUN: c-arcmt-test -mt-migrate-directory %t | arcmt-test -verify-transformed-files %S/Inputs/test1.m.in.result %S/Inputs/test2.m.in.result %S/Inputs/test.h.result
+// RUN: rm -rf %t
+
+// Both files change the shared test.h, each in different lines.
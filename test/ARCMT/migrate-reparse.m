@@ -0,0 +1,16 @@
+// RUN: arcmt-test -print-num-parses --args -triple x86_64-apple-macosx10.7 -fsyntax-only %s 2>&1 | FileCheck %s
+
+// Nothing here needs migrating, so every transform reuses the first parse.
+// CHECK: number of parses: 1
+
+#include "Common.h"
+
+@interface Foo : NSObject
+@property (strong) id prop;
+@end
+
+@implementation Foo
+- (void)test:(id)p {
+  self.prop = p;
+}
+@end
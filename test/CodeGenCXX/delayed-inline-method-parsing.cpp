@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -fdelayed-inline-method-parsing \
+// RUN:   -emit-llvm -o - %s | FileCheck %s --implicit-check-not=_ZN3Lib6unusedEv
+
+struct Lib {
+  int unused() { return 0; }
+  int used() { return helper(); }
+  int helper() { return 1; }
+  virtual int virt() { return 2; }
+  Lib() {}
+};
+
+int use() {
+  Lib l;
+  return l.used();
+}
+
+// Only reachable through calls from delayed bodies, and recursive.
+struct Chain {
+  int first() { return second(3); }
+  int second(int n) { return n ? second(n - 1) : third(); }
+  int third() { return 4; }
+};
+
+int useChain() { return Chain().first(); }
+
+// CHECK-DAG: define linkonce_odr i32 @_ZN3Lib4usedEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN3Lib6helperEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN3Lib4virtEv(
+// CHECK-DAG: define linkonce_odr void @_ZN3LibC2Ev(
+// CHECK-DAG: define linkonce_odr i32 @_ZN5Chain5firstEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN5Chain6secondEi(
+// CHECK-DAG: define linkonce_odr i32 @_ZN5Chain5thirdEv(
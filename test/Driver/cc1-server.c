@@ -0,0 +1,25 @@
+// REQUIRES: shell
+// UNSUPPORTED: system-windows
+
+// When the server can't be reached, jobs are run as if it wasn't asked for;
+// in particular, multiple jobs are run as separate processes.
+// RUN: env CLANG_CC1_SERVER=%t.missing %clang -### -c -save-temps %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=MISSING
+// MISSING-NOT: (in-process)
+// RUN: env CLANG_CC1_SERVER=%t.missing %clang -fsyntax-only %s
+
+// Jobs run by a server share its file manager. Unix socket paths are short,
+// so the socket doesn't live next to the other temporaries.
+// RUN: sock=`mktemp -u /tmp/cc1server.XXXXXX` && \
+// RUN: { %clang -cc1server $sock 2> %t.log & } && \
+// RUN: for i in 1 2 3 4 5 6 7 8 9 10; do test -S $sock && break; sleep 1; done && \
+// RUN: ls -l $sock > %t.perm && \
+// RUN: env CLANG_CC1_SERVER=$sock %clang -fsyntax-only %s && \
+// RUN: env CLANG_CC1_SERVER=$sock %clang -fsyntax-only %s && \
+// RUN: %clang -cc1server -stop $sock
+// RUN: FileCheck %s --check-prefix=PERM < %t.perm
+// RUN: FileCheck %s --check-prefix=STATS < %t.log
+// PERM: srw-------
+// STATS: cc1server: 2 jobs, 1 file manager reuses
+
+int f(void) { return 0; }
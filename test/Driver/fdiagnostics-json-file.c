@@ -0,0 +1,3 @@
+// RUN: %clang -### -fsyntax-only -fdiagnostics-json-file=%t.json -fdiagnostics-sarif-file=%t.sarif %s 2>&1 | FileCheck %s
+// CHECK: "-diagnostic-json-file" "{{.*}}.json"
+// CHECK: "-diagnostic-sarif-file" "{{.*}}.sarif"
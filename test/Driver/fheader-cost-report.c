@@ -0,0 +1,6 @@
+// RUN: %clang -### -fsyntax-only -fheader-cost-report %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=STDERR %s
+// RUN: %clang -### -fsyntax-only -fheader-cost-report=costs.txt %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=FILE %s
+// STDERR: "-fheader-cost-report"
+// FILE: "-fheader-cost-report=costs.txt"
@@ -0,0 +1,4 @@
+// RUN: %clang -### -E -fpreprocessed-chunk-dir=chunks %s 2>&1 | FileCheck %s
+// RUN: %clang -### -c -fpreprocessed-chunk-dir=chunks -x cpp-output %s 2>&1 \
+// RUN:   | FileCheck %s
+// CHECK: "-preprocessed-chunk-dir" "chunks"
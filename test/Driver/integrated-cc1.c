@@ -0,0 +1,16 @@
+// RUN: %clang -### -fintegrated-cc1 -c %s 2>&1 | FileCheck %s --check-prefix=YES
+// YES: (in-process)
+// YES-NEXT: "-cc1"
+
+// RUN: %clang -### -fno-integrated-cc1 -c %s 2>&1 | FileCheck %s --check-prefix=NO
+// RUN: %clang -### -c %s 2>&1 | FileCheck %s --check-prefix=NO
+// NO-NOT: (in-process)
+// NO: "-cc1"
+
+// Multiple jobs are always run as separate processes.
+// RUN: %clang -### -fintegrated-cc1 -c -save-temps %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=MULTI
+// MULTI-NOT: (in-process)
+
+// RUN: %clang -fintegrated-cc1 -fsyntax-only %s
+int f(void) { return 0; }
@@ -0,0 +1,6 @@
+#ifndef HEADER_COST_REPORT_H
+#define HEADER_COST_REPORT_H
+int used_function(int);
+int unused_function(int);
+struct unused_struct { int member; };
+#endif
@@ -0,0 +1,41 @@
+// Declarations long enough to be stored as a preprocessed chunk.
+int chunk_function_00(int first_argument, int second_argument);
+int chunk_function_01(int first_argument, int second_argument);
+int chunk_function_02(int first_argument, int second_argument);
+int chunk_function_03(int first_argument, int second_argument);
+int chunk_function_04(int first_argument, int second_argument);
+int chunk_function_05(int first_argument, int second_argument);
+int chunk_function_06(int first_argument, int second_argument);
+int chunk_function_07(int first_argument, int second_argument);
+int chunk_function_08(int first_argument, int second_argument);
+int chunk_function_09(int first_argument, int second_argument);
+int chunk_function_10(int first_argument, int second_argument);
+int chunk_function_11(int first_argument, int second_argument);
+int chunk_function_12(int first_argument, int second_argument);
+int chunk_function_13(int first_argument, int second_argument);
+int chunk_function_14(int first_argument, int second_argument);
+int chunk_function_15(int first_argument, int second_argument);
+int chunk_function_16(int first_argument, int second_argument);
+int chunk_function_17(int first_argument, int second_argument);
+int chunk_function_18(int first_argument, int second_argument);
+int chunk_function_19(int first_argument, int second_argument);
+int chunk_function_20(int first_argument, int second_argument);
+int chunk_function_21(int first_argument, int second_argument);
+int chunk_function_22(int first_argument, int second_argument);
+int chunk_function_23(int first_argument, int second_argument);
+int chunk_function_24(int first_argument, int second_argument);
+int chunk_function_25(int first_argument, int second_argument);
+int chunk_function_26(int first_argument, int second_argument);
+int chunk_function_27(int first_argument, int second_argument);
+int chunk_function_28(int first_argument, int second_argument);
+int chunk_function_29(int first_argument, int second_argument);
+int chunk_function_30(int first_argument, int second_argument);
+int chunk_function_31(int first_argument, int second_argument);
+int chunk_function_32(int first_argument, int second_argument);
+int chunk_function_33(int first_argument, int second_argument);
+int chunk_function_34(int first_argument, int second_argument);
+int chunk_function_35(int first_argument, int second_argument);
+int chunk_function_36(int first_argument, int second_argument);
+int chunk_function_37(int first_argument, int second_argument);
+int chunk_function_38(int first_argument, int second_argument);
+int chunk_function_39(int first_argument, int second_argument);
@@ -0,0 +1,15 @@
+// Remarks are not counted per group, only warnings and errors are.
+// RUN: %clang_cc1 %s -Rpass=inline -Wunused-variable -fdiagnostics-show-group-counts -emit-llvm-only 2>&1 | FileCheck %s
+
+__attribute__((always_inline)) static int foo(int x) { return x; }
+
+int bar(int j) {
+  int unused;
+  return foo(j);
+}
+
+// CHECK: warning: unused variable 'unused'
+// CHECK: remark: foo inlined into bar
+// CHECK: diagnostic counts by group:
+// CHECK-NEXT: -Wunused-variable: 1
+// CHECK-NOT: pass
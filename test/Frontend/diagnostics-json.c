@@ -0,0 +1,36 @@
+// RUN: rm -f %t.json %t.sarif
+// RUN: not %clang_cc1 -fsyntax-only -Wunused-variable -diagnostic-json-file %t.json -diagnostic-sarif-file %t.sarif %s 2> /dev/null
+// RUN: FileCheck --check-prefix=JSON %s < %t.json
+// RUN: FileCheck --check-prefix=SARIF %s < %t.sarif
+//
+// A second compile appends to the JSON file.
+// RUN: not %clang_cc1 -fsyntax-only -diagnostic-json-file %t.json %s 2> /dev/null
+// RUN: grep -c '"level":"error"' %t.json | FileCheck --check-prefix=APPEND %s
+//
+// A file that can't be opened is reported, and the compile goes on.
+// RUN: not %clang_cc1 -fsyntax-only -diagnostic-sarif-file %t.missing/x.sarif %s 2>&1 | FileCheck --check-prefix=OPEN %s
+
+#ifdef IS_HEADER
+int h = undeclared;
+#else
+#define IS_HEADER
+#include __FILE__
+struct S { int x; }
+void f(void) { int unused; }
+#endif
+
+// JSON: {"main-file":"{{.*}}diagnostics-json.c","level":"error","message":"use of undeclared identifier 'undeclared'","category":"Semantic Issue","location":{"file":"{{.*}}diagnostics-json.c","line":11,"column":9},"include-stack":[{"file":"{{.*}}diagnostics-json.c","line":14,"column":{{[0-9]+}}}]}
+// JSON-NEXT: {"main-file":"{{.*}}diagnostics-json.c","level":"error","message":"expected ';' after struct","category":"Parse Issue","location":{"file":"{{.*}}diagnostics-json.c","line":15,"column":20},"fixits":[{"begin":{"file":"{{.*}}diagnostics-json.c","line":15,"column":20},"end":{"file":"{{.*}}diagnostics-json.c","line":15,"column":20},"text":";"}]}
+// JSON-NEXT: {"main-file":"{{.*}}diagnostics-json.c","level":"warning","message":"unused variable 'unused'","option":"-Wunused-variable","category":"Semantic Issue","location":{"file":"{{.*}}diagnostics-json.c","line":16,"column":20}}
+// JSON-NOT: {
+
+// SARIF: {"$schema":"https://json.schemastore.org/sarif-2.1.0.json","version":"2.1.0","runs":[{"tool":{"driver":{"name":"clang","fullName":"{{.*}}"}},"results":[
+// SARIF-NEXT: {"level":"error","message":{"text":"use of undeclared identifier 'undeclared'"},"locations":[{"physicalLocation":{"artifactLocation":{"uri":"file://{{.*}}/diagnostics-json.c"},"region":{"startLine":11,"startColumn":9}}}],"stacks":[{"message":{"text":"include stack"},"frames":[{"location":{"physicalLocation":{"artifactLocation":{"uri":"file://{{.*}}/diagnostics-json.c"},"region":{"startLine":14,"startColumn":{{[0-9]+}}}}}}]}],"properties":{"category":"Semantic Issue"}},
+// SARIF-NEXT: {"level":"error","message":{"text":"expected ';' after struct"},"locations":[{"physicalLocation":{"artifactLocation":{"uri":"file://{{.*}}/diagnostics-json.c"},"region":{"startLine":15,"startColumn":20}}}],"fixes":[{"artifactChanges":[{"artifactLocation":{"uri":"file://{{.*}}/diagnostics-json.c"},"replacements":[{"deletedRegion":{"startLine":15,"startColumn":20,"endLine":15,"endColumn":20},"insertedContent":{"text":";"}}]}]}],"properties":{"category":"Parse Issue"}},
+// SARIF-NEXT: {"ruleId":"-Wunused-variable","level":"warning","message":{"text":"unused variable 'unused'"},"locations":[{"physicalLocation":{"artifactLocation":{"uri":"file://{{.*}}/diagnostics-json.c"},"region":{"startLine":16,"startColumn":20}}}],"properties":{"category":"Semantic Issue"}}
+// SARIF-NEXT: ]}]}
+
+// APPEND: 4
+
+// OPEN: warning: unable to open file {{.*}}x.sarif for writing diagnostics
+// OPEN: error: use of undeclared identifier 'undeclared'
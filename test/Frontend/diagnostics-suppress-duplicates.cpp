@@ -0,0 +1,26 @@
+// RUN: not %clang_cc1 -fsyntax-only -Wunused-variable -fdiagnostics-suppress-duplicates -fdiagnostics-show-group-counts %s 2>&1 | FileCheck %s
+// RUN: not %clang_cc1 -fsyntax-only -Wunused-variable %s 2>&1 | FileCheck --check-prefix=ALL %s
+
+template <typename T> void f() { g(T()); }
+
+void h() {
+  int unused;
+  f<int>();
+  f<long>();
+}
+
+// CHECK: warning: unused variable 'unused'
+// CHECK: error: use of undeclared identifier 'g'
+// CHECK: note: in instantiation of function template specialization 'f<int>' requested here
+// CHECK-NOT: f<long>
+// CHECK: 1 warning and 1 error generated.
+// CHECK-NEXT: diagnostic counts by group:
+// CHECK-NEXT:   (no group): 2 (1 duplicate suppressed)
+// CHECK-NEXT:   -Wunused-variable: 1
+
+// ALL: error: use of undeclared identifier 'g'
+// ALL: note: in instantiation of function template specialization 'f<int>' requested here
+// ALL: error: use of undeclared identifier 'g'
+// ALL: note: in instantiation of function template specialization 'f<long>' requested here
+// ALL: 1 warning and 2 errors generated.
+// ALL-NOT: diagnostic counts
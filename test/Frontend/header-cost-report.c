@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs -fheader-cost-report %s 2>&1 \
+// RUN:   | FileCheck %s
+// RUN: rm -f %t
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs -fheader-cost-report=%t %s
+// RUN: FileCheck -input-file %t %s
+
+#include "header-cost-report.h"
+#include "header-cost-report.h"
+
+int main_value(void) { return used_function(1); }
+
+// The guarded header is included twice but only entered and lexed once. It
+// declares two functions and a struct with one member; one function is used.
+// CHECK: *** Header Cost Report for '{{.*}}header-cost-report.c':
+// CHECK-NEXT: Time (s)  Includes   Entered       Bytes     Tokens    Decls  Referenced  Header
+// CHECK-NEXT: {{[0-9.]+}}         2         1  [[BYTES:[0-9]+]]         {{[0-9]+}}        4           1  {{.*}}header-cost-report.h
+// CHECK-NEXT: {{[0-9.]+}}         2         1  [[BYTES]]         {{[0-9]+}}        4           1  (total)
@@ -0,0 +1,33 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang_cc1 -E -I %S/Inputs -preprocessed-chunk-dir %t/chunks %s -o %t/compact.i
+// RUN: FileCheck -check-prefix=COMPACT -input-file %t/compact.i %s
+// RUN: ls %t/chunks | count 1
+
+// The compact output needs its chunks to compile.
+// RUN: not %clang_cc1 -fsyntax-only %t/compact.i 2>&1 \
+// RUN:   | FileCheck -check-prefix=NOCHUNKS %s
+// RUN: not %clang_cc1 -fsyntax-only -preprocessed-chunk-dir %t/chunks \
+// RUN:   %t/compact.i 2>&1 | FileCheck -check-prefix=DIAG %s
+
+// A damaged chunk is rejected.
+// RUN: for f in %t/chunks/*.i; do echo "int x;" > $f; done
+// RUN: not %clang_cc1 -fsyntax-only -preprocessed-chunk-dir %t/chunks \
+// RUN:   %t/compact.i 2>&1 | FileCheck -check-prefix=DAMAGED %s
+
+#include "preprocessed-chunks.h"
+
+int main_file_value = chunk_function_39(1, 2);
+int undeclared_value = not_declared;
+
+// COMPACT: # 1 "{{.*}}preprocessed-chunks.h" 1
+// COMPACT-NEXT: #include_chunk "{{[0-9a-f]+}}"
+// COMPACT-NEXT: # {{[0-9]+}} "{{.*}}preprocessed-chunks.c" 2
+// COMPACT: int main_file_value = chunk_function_39(1, 2);
+
+// NOCHUNKS: error: invalid preprocessing directive
+
+// DIAG-NOT: error
+// DIAG: preprocessed-chunks.c:20:24: error: use of undeclared identifier 'not_declared'
+// DIAG-NOT: error
+
+// DAMAGED: fatal error: unable to read preprocessed chunk '{{.*}}': 'contents do not match the hash'
@@ -0,0 +1,22 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -fsyntax-only -print-startup-stats %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=SYNTAX
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -S -o /dev/null -print-startup-stats %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=CODEGEN
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -fsyntax-only -fasm-blocks -print-startup-stats %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=CODEGEN
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -fsyntax-only -version -print-startup-stats %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=ALL
+
+// SYNTAX: *** Startup Stats:
+// SYNTAX: parsing arguments
+// SYNTAX: initializing LLVM targets (none)
+// SYNTAX: executing the frontend action
+
+// CODEGEN: *** Startup Stats:
+// CODEGEN: initializing LLVM targets (X86)
+
+// -version lists every registered target.
+// ALL: initializing LLVM targets (all)
+
+int f(void) { return 0; }
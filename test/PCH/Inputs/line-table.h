@@ -0,0 +1,5 @@
+// Header for line-table.c.
+
+int first(int);
+    int second(int a,
+               int b);
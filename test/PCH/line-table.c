@@ -0,0 +1,15 @@
+// Check that locations in a PCH header have the right line and column when
+// the header's line table is loaded from the PCH.
+
+// RUN: %clang_cc1 -emit-pch -o %t %S/Inputs/line-table.h
+// RUN: not %clang_cc1 -fsyntax-only -include-pch %t -print-stats %s 2>&1 \
+// RUN:   | FileCheck %s
+
+int x = second(1);
+// CHECK: line-table.c:[[@LINE-1]]:17: error: too few arguments
+// CHECK: line-table.h:4:5: note: 'second' declared here
+int y = first(1, 2);
+// CHECK: line-table.c:[[@LINE-1]]:18: error: too many arguments
+// CHECK: line-table.h:3:1: note: 'first' declared here
+
+// CHECK: files with line #'s computed ({{[1-9][0-9]*}} loaded from AST files)
@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// The outcome of disambiguating a function declarator inside a tentatively
+// parsed statement is reused when the statement is parsed for real, and must
+// still report the ambiguity.
+
+struct S { S(int); };
+struct T { T(S); };
+
+void f() {
+  T a(S(b)); // expected-warning {{disambiguated as a function declaration}} expected-note {{add a pair of parentheses}}
+  T c(S(1));
+  int d(int(e)), g(1); // expected-warning {{disambiguated as a function declaration}} expected-note {{add a pair of parentheses}}
+  T h((S(2)));
+  c = T(S(3));
+}
+
+// CHECK: *** Parser Stats:
+// CHECK-NEXT: {{[0-9]+}} disambiguating tentative parses, {{[1-9][0-9]*}} reused from the cache.
+// CHECK-NEXT: {{[1-9][0-9]*}} tokens not re-scanned thanks to the cache.
@@ -0,0 +1,41 @@
+// RUN: %clang_cc1 -std=c++11 -fdelayed-inline-method-parsing -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++11 -fdelayed-inline-method-parsing -fsyntax-only -print-stats %s 2>&1 \
+// RUN:   | FileCheck %s
+
+struct Lib {
+  // Bodies which are never used are never parsed, so this isn't diagnosed.
+  int unused() { return undeclared_name; }
+  int used() { return helper(); }
+  int helper() { return 1; }
+
+  // Used by the default member initializer, so parsed with the class.
+  int viaInit() { return 2; }
+  int fromInit = viaInit();
+
+  // Virtual functions are needed with the vtable and aren't delayed.
+  virtual int virt() { return 3; }
+  constexpr int fixed() const { return 4; }
+
+  Lib() {}
+  ~Lib() {}
+};
+
+int useLib() {
+  Lib l;
+  return l.used();
+}
+
+// Bodies are parsed at the end of the translation unit, and diagnosed there.
+struct Bad {
+  int f() { return missing; } // expected-error {{use of undeclared identifier 'missing'}}
+};
+int useBad() { return Bad().f(); }
+
+// Name lookup in a delayed body finds declarations after the class.
+struct Late {
+  int f() { return later(); }
+};
+int later();
+int useLate() { return Late().f(); }
+
+// CHECK: 7 inline method bodies delayed, 6 parsed when used.
@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// Top-level functions share one function scope; the methods of local
+// classes reuse the scope of an earlier nested function.
+void f1() {
+  struct L {
+    void g() {}
+    void h() {}
+  };
+}
+
+void f2() {
+  struct L {
+    void g() {}
+  };
+}
+
+// Lambdas always get a scope of their own.
+auto lambda = [] { return 0; };
+
+// CHECK: 3 top-level declarations, {{[0-9]+}} scopes and 3 function scopes allocated ({{[0-9.]+}} per declaration), {{[0-9]+}} scopes and 4 function scopes reused.
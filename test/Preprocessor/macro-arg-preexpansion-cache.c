@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -E %s | FileCheck %s
+// RUN: %clang_cc1 -fsyntax-only -Wunused-macros -verify %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=STATS %s
+// expected-no-diagnostics
+
+#define NULL ((void*)0)
+#define CHECK(x) ((x) ? 1 : 0)
+
+int F;
+#define F(x) CHECK(F) + x
+
+int check(int *p) {
+  // CHECK: int a = ((p != ((void*)0)) ? 1 : 0);
+  int a = CHECK(p != NULL);
+  // Identical arguments replay the first pre-expansion.
+  // CHECK: int b = ((p != ((void*)0)) ? 1 : 0);
+  int b = CHECK(p != NULL);
+  // CHECK: int c = ((p != ((void*)0)) ? 1 : 0);
+  int c = CHECK(p  !=  NULL);
+
+#undef NULL
+#define NULL 0
+  // A new definition invalidates what was recorded.
+  // CHECK: int d = ((p != 0) ? 1 : 0);
+  int d = CHECK(p != NULL);
+
+  // CHECK: int e = ((F) ? 1 : 0);
+  int e = CHECK(F);
+  // F is disabled inside its own expansion, so this can't be replayed.
+  // CHECK: int f = ((F) ? 1 : 0) + 1;
+  int f = F(1);
+
+  // CHECK: int g = ((p != 0) ? 1 : 0);
+  int g = CHECK(p != NULL);
+  return a + b + c + d + e + f + g;
+}
+
+// STATS: 4 macro arguments pre-expanded, 3 replayed from earlier identical arguments.
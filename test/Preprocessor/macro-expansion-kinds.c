@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -undef -E %s | FileCheck %s
+// RUN: %clang_cc1 -undef -fsyntax-only -print-stats %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=STATS %s
+
+#define EMPTY
+#define ONE 1
+#define TWO 1 + 1
+#define UNUSED_ARG(x) (0)
+#define NO_ARGS() 2 + 2
+#define ID(x) (x)
+#define STR(x) #x
+
+// CHECK: int a = 1;
+int a = EMPTY ONE;
+// CHECK: int b = 1 + 1;
+int b = TWO;
+// Arguments which aren't used are never expanded.
+// CHECK: int c = (0) + (0);
+int c = UNUSED_ARG(TWO) + UNUSED_ARG();
+// CHECK: int d = 2 + 2;
+int d = NO_ARGS();
+// CHECK: int e = (1);
+int e = ID(ONE);
+// CHECK: const char *s = "ONE";
+const char *s = STR(ONE);
+// CHECK: int l = 27;
+int l = __LINE__;
+// CHECK: #pragma GCC diagnostic push
+_Pragma("GCC diagnostic push")
+
+// STATS: 4/5/2 obj/fn/builtin macros expanded, 3 on the fast path.
+// STATS-NEXT: 1 expanded to nothing, 2 to a single token, 3 function-like without substituting arguments.
@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -cache-predefines -triple x86_64-unknown-linux-gnu -fsyntax-only -verify -print-stats %s %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -cache-predefines -triple i686-pc-mingw32 -fsyntax-only -verify %s %s
+// expected-no-diagnostics
+
+// The first compilation parses the predefines, the second one reuses them.
+// CHECK: 0 predefined macros installed from the predefines cache.
+// CHECK: {{[1-9][0-9]*}} predefined macros installed from the predefines cache.
+
+#if __STDC_VERSION__ < 199901L || !defined(__STDC_HOSTED__)
+#error "missing standard predefines"
+#endif
+
+#if __SIZEOF_INT__ != 4 || __CHAR_BIT__ != 8
+#error "missing target predefines"
+#endif
+
+const char Version[] = __VERSION__;
+long long Max = __LONG_LONG_MAX__;
+
+#ifdef _WIN32
+__declspec(dllexport) void f(void);
+#endif
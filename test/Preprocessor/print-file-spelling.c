@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -E -C %s | FileCheck -strict-whitespace %s
+
+// Tokens spelled directly in the file are copied from the file buffer; check
+// that tokens needing cleaning, digraphs, comments and tokens from macro
+// expansions are still printed correctly around them.
+
+#define PLUS +
+#define CAT(a, b) a ## b
+
+int x = 1 PLUS 2 <<= 3;
+// CHECK: int x = 1 + 2 <<= 3;
+int y <: 4 :> = { CAT(fo, o) };
+// CHECK: int y <: 4 :> = { foo };
+int z = a+\
++b - -c;
+// CHECK: int z = a++b - -c;
+f /* multi
+     line */ (x);
+// CHECK: f /* multi
+// CHECK-NEXT:      line */ (x);
+g(x);
+// CHECK-NEXT: g(x);
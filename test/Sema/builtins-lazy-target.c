@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -fsyntax-only -verify %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -fsyntax-only -print-stats %s 2>&1 \
+// RUN:   | FileCheck %s
+// expected-no-diagnostics
+
+// Target builtins are only entered in the identifier table when used.
+
+#if !__has_builtin(__builtin_ia32_pause)
+#error "target builtin not found"
+#endif
+
+#if __has_builtin(__builtin_ia32_not_a_builtin)
+#error "unexpected target builtin"
+#endif
+
+void f(void) {
+  __builtin_ia32_pause();
+}
+
+// CHECK: *** Builtin Stats:
+// CHECK: # Lazily marked builtins: 1{{$}}
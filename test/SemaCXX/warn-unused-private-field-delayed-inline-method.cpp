@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -fsyntax-only -fdelayed-inline-method-parsing -Wunused-private-field -verify -std=c++11 %s
+
+// The body that uses the field is never parsed, so the field may be used.
+class UsedInUnparsedBody {
+  int x;
+public:
+  int get() { return x; }
+};
+
+// Once every body has been parsed, unused fields are diagnosed again.
+class AllBodiesParsed {
+  int y; // expected-warning {{private field 'y' is not used}}
+public:
+  int get() { return 0; }
+};
+int useAllBodiesParsed() { return AllBodiesParsed().get(); }
@@ -42,6 +42,11 @@ VerifyDiags("verify",llvm::cl::desc("Verify emitted diagnostics and warnings"));
 static llvm::cl::opt<bool>
 VerboseOpt("v", llvm::cl::desc("Enable verbose output"));
 
+static llvm::cl::opt<bool>
+PrintNumParses("print-num-parses",
+               llvm::cl::desc("Print how many times the transformations "
+                              "parsed the input"));
+
 static llvm::cl::opt<bool>
 VerifyTransformedFiles("verify-transformed-files",
 llvm::cl::desc("Read pairs of file mappings (typically the output of "
@@ -53,6 +58,16 @@ RemappingsFile("remappings-file",
                llvm::cl::desc("Pairs of file mappings (typically the output of "
                "c-arcmt-test)"));
 
+static llvm::cl::opt<std::string>
+MigrateDirectory("migrate-directory",
+                 llvm::cl::desc("Migrate all the input files, writing the "
+                                "result into the given directory"));
+
+static llvm::cl::opt<unsigned>
+NumJobs("jobs", llvm::cl::init(0),
+        llvm::cl::desc("Number of files -migrate-directory migrates at a "
+                       "time (default: one per hardware thread)"));
+
 static llvm::cl::list<std::string>
 ResultFiles(llvm::cl::Positional, llvm::cl::desc("<filename>..."));
 
@@ -202,11 +217,39 @@ static bool performTransformations(StringRef resourcesPath,
   if (!OutputTransformations)
     printResult(migration.getRemapper(), llvm::outs());
 
+  if (PrintNumParses)
+    llvm::errs() << "number of parses: " << migration.getNumParses() << "\n";
+
   // FIXME: TestResultForARC
 
   return false;
 }
 
+static bool migrateFiles(StringRef resourcesPath,
+                         ArrayRef<const char *> Args) {
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  DiagnosticConsumer *DiagClient =
+    new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts);
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  IntrusiveRefCntPtr<DiagnosticsEngine> TopDiags(
+      new DiagnosticsEngine(DiagID, &*DiagOpts, &*DiagClient));
+
+  CompilerInvocation origCI;
+  if (!CompilerInvocation::CreateFromArgs(origCI, Args.begin(), Args.end(),
+                                     *TopDiags))
+    return true;
+
+  if (origCI.getFrontendOpts().Inputs.empty()) {
+    llvm::errs() << "error: no input files\n";
+    return true;
+  }
+
+  std::vector<FrontendInputFile> Inputs = origCI.getFrontendOpts().Inputs;
+  return arcmt::migrateInParallel(origCI, Inputs,
+                                  std::make_shared<PCHContainerOperations>(),
+                                  llvm::errs(), MigrateDirectory, NumJobs);
+}
+
 static bool filesCompareEqual(StringRef fname1, StringRef fname2) {
   using namespace llvm;
 
@@ -373,5 +416,8 @@ int main(int argc, const char **argv) {
   if (CheckOnly)
     return checkForMigration(resourcesPath, Args);
 
+  if (!MigrateDirectory.empty())
+    return migrateFiles(resourcesPath, Args);
+
   return performTransformations(resourcesPath, Args);
 }
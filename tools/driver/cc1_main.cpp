@@ -26,17 +26,20 @@
 #include "clang/Frontend/Utils.h"
 #include "clang/FrontendTool/Utils.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/LinkAllPasses.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
+#include <functional>
 
 #ifdef CLANG_HAVE_RLIMITS
 #include <sys/resource.h>
@@ -129,7 +132,159 @@ static void ensureSufficientStack() {
 static void ensureSufficientStack() {}
 #endif
 
-int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
+/// Return the name of the LLVM target which generates code for \p Arch, or an
+/// empty string if unknown.
+static StringRef getLLVMTargetName(llvm::Triple::ArchType Arch) {
+  switch (Arch) {
+  case llvm::Triple::aarch64:
+  case llvm::Triple::aarch64_be:
+    return "AArch64";
+  case llvm::Triple::amdgcn:
+  case llvm::Triple::r600:
+    return "AMDGPU";
+  case llvm::Triple::arm:
+  case llvm::Triple::armeb:
+  case llvm::Triple::thumb:
+  case llvm::Triple::thumbeb:
+    return "ARM";
+  case llvm::Triple::bpfeb:
+  case llvm::Triple::bpfel:
+    return "BPF";
+  case llvm::Triple::hexagon:
+    return "Hexagon";
+  case llvm::Triple::lanai:
+    return "Lanai";
+  case llvm::Triple::mips:
+  case llvm::Triple::mipsel:
+  case llvm::Triple::mips64:
+  case llvm::Triple::mips64el:
+    return "Mips";
+  case llvm::Triple::msp430:
+    return "MSP430";
+  case llvm::Triple::nvptx:
+  case llvm::Triple::nvptx64:
+    return "NVPTX";
+  case llvm::Triple::ppc:
+  case llvm::Triple::ppc64:
+  case llvm::Triple::ppc64le:
+    return "PowerPC";
+  case llvm::Triple::sparc:
+  case llvm::Triple::sparcel:
+  case llvm::Triple::sparcv9:
+    return "Sparc";
+  case llvm::Triple::systemz:
+    return "SystemZ";
+  case llvm::Triple::wasm32:
+  case llvm::Triple::wasm64:
+    return "WebAssembly";
+  case llvm::Triple::x86:
+  case llvm::Triple::x86_64:
+    return "X86";
+  case llvm::Triple::xcore:
+    return "XCore";
+  default:
+    return StringRef();
+  }
+}
+
+/// Register the LLVM target called \p Name, if it was built.
+static bool initializeLLVMTarget(StringRef Name) {
+  bool Found = false;
+#define LLVM_TARGET(TargetName)                                                \
+  if (Name == #TargetName) {                                                   \
+    LLVMInitialize##TargetName##TargetInfo();                                  \
+    LLVMInitialize##TargetName##Target();                                      \
+    LLVMInitialize##TargetName##TargetMC();                                    \
+    Found = true;                                                              \
+  }
+#include "llvm/Config/Targets.def"
+  if (!Found)
+    return false;
+
+#define LLVM_ASM_PRINTER(TargetName)                                           \
+  if (Name == #TargetName)                                                     \
+    LLVMInitialize##TargetName##AsmPrinter();
+#include "llvm/Config/AsmPrinters.def"
+#define LLVM_ASM_PARSER(TargetName)                                            \
+  if (Name == #TargetName)                                                     \
+    LLVMInitialize##TargetName##AsmParser();
+#include "llvm/Config/AsmParsers.def"
+  return true;
+}
+
+namespace {
+/// The LLVM backends executing a CompilerInstance may need.
+enum LLVMTargetNeeds {
+  NeedsNoLLVMTarget,
+  NeedsTripleLLVMTarget,
+  NeedsAllLLVMTargets
+};
+} // end anonymous namespace
+
+/// Register the LLVM backend for \p TripleStr, or all of them if \p All is
+/// set or the backend cannot be determined. Returns a description of what was
+/// registered.
+static StringRef initializeLLVMTargets(StringRef TripleStr, bool All) {
+  StringRef Name = getLLVMTargetName(llvm::Triple(TripleStr).getArch());
+  if (!All && !Name.empty() && initializeLLVMTarget(Name))
+    return Name;
+
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+  return "all";
+}
+
+/// Return which LLVM backends executing \p Clang may need.
+static LLVMTargetNeeds getLLVMTargetNeeds(CompilerInstance &Clang) {
+  const FrontendOptions &FEOpts = Clang.getFrontendOpts();
+
+  // -version lists all the registered targets, and plugins may use any of
+  // them.
+  if (FEOpts.ShowVersion || !FEOpts.Plugins.empty() ||
+      !FEOpts.AddPluginActions.empty())
+    return NeedsAllLLVMTargets;
+
+  switch (FEOpts.ProgramAction) {
+  case frontend::ASTDeclList:
+  case frontend::ASTDump:
+  case frontend::ASTPrint:
+  case frontend::ASTView:
+  case frontend::DumpRawTokens:
+  case frontend::DumpTokens:
+  case frontend::EmitHTML:
+  case frontend::FixIt:
+  case frontend::InitOnly:
+  case frontend::ParseSyntaxOnly:
+  case frontend::PrintDeclContext:
+  case frontend::PrintPreamble:
+  case frontend::PrintPreprocessedInput:
+  case frontend::RewriteMacros:
+  case frontend::RewriteTest:
+  case frontend::RunPreprocessorOnly:
+    break;
+  default:
+    return NeedsTripleLLVMTarget;
+  }
+
+  // Microsoft inline assembly is parsed by the target's MC layer.
+  if (Clang.getLangOpts().AsmBlocks)
+    return NeedsTripleLLVMTarget;
+
+  // Implicitly built modules may be wrapped in an object file.
+  if (Clang.getLangOpts().Modules &&
+      Clang.getHeaderSearchOpts().ModuleFormat == "obj")
+    return NeedsTripleLLVMTarget;
+
+  return NeedsNoLLVMTarget;
+}
+
+/// Run a -cc1 invocation. If \p Customize is set, it is called with the
+/// configured CompilerInstance before any action runs; returning false aborts
+/// the compilation.
+int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr,
+             const std::function<bool(CompilerInstance &)> &Customize) {
   ensureSufficientStack();
 
   std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
@@ -140,12 +295,6 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   PCHOps->registerWriter(llvm::make_unique<ObjectFilePCHContainerWriter>());
   PCHOps->registerReader(llvm::make_unique<ObjectFilePCHContainerReader>());
 
-  // Initialize targets first, so that --version shows registered targets.
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmPrinters();
-  llvm::InitializeAllAsmParsers();
-
 #ifdef LINK_POLLY_INTO_TOOLS
   llvm::PassRegistry &Registry = *llvm::PassRegistry::getPassRegistry();
   polly::initializePollyPasses(Registry);
@@ -156,8 +305,20 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
   TextDiagnosticBuffer *DiagsBuffer = new TextDiagnosticBuffer;
   DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagsBuffer);
+  llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime();
   bool Success = CompilerInvocation::CreateFromArgs(
       Clang->getInvocation(), Argv.begin(), Argv.end(), Diags);
+  llvm::TimeRecord ArgsTime = llvm::TimeRecord::getCurrentTime();
+
+  // Register the LLVM backends only once we know which one, if any, is going
+  // to be used.
+  StringRef InitializedTargets = "none";
+  LLVMTargetNeeds TargetNeeds = getLLVMTargetNeeds(*Clang);
+  if (TargetNeeds != NeedsNoLLVMTarget)
+    InitializedTargets =
+        initializeLLVMTargets(Clang->getTargetOpts().Triple,
+                              TargetNeeds == NeedsAllLLVMTargets);
+  llvm::TimeRecord TargetsTime = llvm::TimeRecord::getCurrentTime();
 
   // Infer the builtin include path if unspecified.
   if (Clang->getHeaderSearchOpts().UseBuiltinIncludes &&
@@ -179,9 +340,29 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   if (!Success)
     return 1;
 
+  if (Customize && !Customize(*Clang)) {
+    llvm::remove_fatal_error_handler();
+    return 1;
+  }
+
   // Execute the frontend actions.
   Success = ExecuteCompilerInvocation(Clang.get());
 
+  if (Clang->getFrontendOpts().ShowStartupStats) {
+    llvm::TimeRecord EndTime = llvm::TimeRecord::getCurrentTime();
+    llvm::errs() << "\n*** Startup Stats:\n";
+    llvm::errs() << llvm::format(
+        "%10.4fs parsing arguments\n",
+        ArgsTime.getWallTime() - StartTime.getWallTime());
+    llvm::errs() << llvm::format(
+        "%10.4fs initializing LLVM targets (%s)\n",
+        TargetsTime.getWallTime() - ArgsTime.getWallTime(),
+        InitializedTargets.str().c_str());
+    llvm::errs() << llvm::format(
+        "%10.4fs executing the frontend action\n",
+        EndTime.getWallTime() - TargetsTime.getWallTime());
+  }
+
   // If any timers were active but haven't been destroyed yet, print their
   // results now.  This happens in -disable-free mode.
   llvm::TimerGroup::printAll(llvm::errs());
@@ -199,3 +380,8 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
 
   return !Success;
 }
+
+int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
+  return cc1_main(Argv, Argv0, MainAddr,
+                  std::function<bool(CompilerInstance &)>());
+}
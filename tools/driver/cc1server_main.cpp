@@ -0,0 +1,469 @@
+//===-- cc1server_main.cpp - Clang CC1 Compile Server ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the entry point to the clang -cc1server functionality, a long-lived
+// process which runs -cc1 jobs sent to it by the driver over a Unix domain
+// socket (see CLANG_CC1_SERVER in driver.cpp).
+//
+// Keeping the process alive avoids paying for process startup and target
+// initialization on every job, and lets consecutive jobs share a FileManager
+// and its file and directory caches. The shared FileManager is revalidated
+// against the file system (identity, size and modification time of every
+// cached entry, and absence of every cached failure) before each reuse. Jobs
+// with the same compiler configuration also share their parsed predefined
+// macros (see PredefinesCache).
+//
+// Jobs are run one at a time, and only for the user running the server: the
+// socket is only accessible to its owner, and peers with another user ID are
+// rejected where the system can tell. 'clang -cc1server -stop <socket>' asks
+// the server to exit.
+//
+// The protocol is private to this file; all integers are in host byte order
+// since the client runs on the same host:
+//
+//   request:  uint64 size, followed by the working directory and the -cc1
+//             argument vector (starting with argv[0]), each NUL-terminated.
+//             An empty request asks the server to exit.
+//   response: int32 exit status, then the captured stdout and stderr, each as
+//             a uint64 size followed by the bytes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/DiagnosticFrontend.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LLVM.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef LLVM_ON_UNIX
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace clang;
+
+extern int cc1_main(ArrayRef<const char *> Argv, const char *Argv0,
+                    void *MainAddr,
+                    const std::function<bool(CompilerInstance &)> &Customize);
+
+#ifdef LLVM_ON_UNIX
+
+static bool writeAll(int FD, const void *Data, size_t Size) {
+  const char *Ptr = static_cast<const char *>(Data);
+  while (Size) {
+    ssize_t N = ::write(FD, Ptr, Size);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    Ptr += N;
+    Size -= N;
+  }
+  return true;
+}
+
+static bool readAll(int FD, void *Data, size_t Size) {
+  char *Ptr = static_cast<char *>(Data);
+  while (Size) {
+    ssize_t N = ::read(FD, Ptr, Size);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    Ptr += N;
+    Size -= N;
+  }
+  return true;
+}
+
+static bool writeBlob(int FD, StringRef Data) {
+  uint64_t Size = Data.size();
+  return writeAll(FD, &Size, sizeof(Size)) &&
+         writeAll(FD, Data.data(), Data.size());
+}
+
+static bool readBlob(int FD, std::string &Data) {
+  uint64_t Size;
+  if (!readAll(FD, &Size, sizeof(Size)))
+    return false;
+  Data.resize(Size);
+  return readAll(FD, &Data[0], Size);
+}
+
+static bool fillSocketAddress(StringRef Path, sockaddr_un &Addr) {
+  memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (Path.size() >= sizeof(Addr.sun_path))
+    return false;
+  memcpy(Addr.sun_path, Path.data(), Path.size());
+  return true;
+}
+
+/// \brief Check that the process connected through \p FD runs as the same user
+/// as the server, on systems which can tell.
+static bool isPeerTrusted(int FD) {
+#ifdef SO_PEERCRED
+  struct ucred Cred;
+  socklen_t Length = sizeof(Cred);
+  if (::getsockopt(FD, SOL_SOCKET, SO_PEERCRED, &Cred, &Length))
+    return false;
+  return Cred.uid == ::geteuid();
+#else
+  return true;
+#endif
+}
+
+namespace {
+/// \brief Redirects a standard file descriptor into a temporary file for the
+/// duration of one job.
+class CapturedFD {
+  int TargetFD;
+  int SavedFD;
+  int TempFD;
+  SmallString<128> TempPath;
+
+public:
+  explicit CapturedFD(int TargetFD)
+      : TargetFD(TargetFD), SavedFD(-1), TempFD(-1) {
+    if (llvm::sys::fs::createTemporaryFile("cc1server", "out", TempFD,
+                                           TempPath))
+      return;
+    SavedFD = ::dup(TargetFD);
+    ::dup2(TempFD, TargetFD);
+  }
+
+  /// \brief Restore the original descriptor and return what was written.
+  std::string release() {
+    if (TempFD < 0)
+      return std::string();
+    ::dup2(SavedFD, TargetFD);
+    ::close(SavedFD);
+    ::close(TempFD);
+    TempFD = -1;
+
+    std::string Result;
+    if (auto Buffer = llvm::MemoryBuffer::getFile(TempPath))
+      Result = (*Buffer)->getBuffer();
+    llvm::sys::fs::remove(TempPath);
+    return Result;
+  }
+
+  ~CapturedFD() { release(); }
+};
+
+/// \brief State kept alive between jobs.
+struct ServerState {
+  /// The FileManager shared by consecutive jobs, if any.
+  IntrusiveRefCntPtr<FileManager> FileMgr;
+
+  /// The working directory of the job which created FileMgr. Relative paths
+  /// in its caches are only meaningful in that directory.
+  std::string FileMgrCWD;
+
+  unsigned NumJobs;
+  unsigned NumFileMgrReuses;
+
+  /// The diagnostics of the running job.
+  DiagnosticsEngine *JobDiags;
+
+  /// The exit status a fatal error in the running job asked for, or 0.
+  int FatalErrorStatus;
+
+  ServerState()
+      : NumJobs(0), NumFileMgrReuses(0), JobDiags(nullptr),
+        FatalErrorStatus(0) {}
+};
+} // end anonymous namespace
+
+/// \brief Replaces the fatal error handler of cc1_main, which exits: the
+/// server abandons the job instead, and keeps serving.
+static void ServerFatalErrorHandler(void *UserData, const std::string &Message,
+                                    bool GenCrashDiag) {
+  ServerState &State = *static_cast<ServerState *>(UserData);
+  State.JobDiags->Report(diag::err_fe_error_backend) << Message;
+
+  // Remove the files registered with RemoveFileOnSignal, like cc1_main does.
+  llvm::sys::RunInterruptHandlers();
+
+  // Jobs always run under a CrashRecoveryContext; unwind out of the job.
+  State.FatalErrorStatus = GenCrashDiag ? 70 : 1;
+  llvm::CrashRecoveryContext::GetCurrent()->HandleCrash();
+}
+
+/// \brief Decide whether \p Clang can use the shared FileManager, and install
+/// it (or make its own FileManager the shared one).
+static bool setupSharedFileManager(ServerState &State, StringRef CWD,
+                                   CompilerInstance &Clang) {
+  // The server outlives the job, so the job has to release its memory.
+  Clang.getFrontendOpts().DisableFree = false;
+  Clang.getCodeGenOpts().DisableFree = false;
+
+  // Virtual file system overlays and remapped files change what the
+  // FileManager sees; don't share caches with such jobs.
+  if (!Clang.getHeaderSearchOpts().VFSOverlayFiles.empty() ||
+      !Clang.getPreprocessorOpts().RemappedFiles.empty() ||
+      !Clang.getPreprocessorOpts().RemappedFileBuffers.empty()) {
+    State.FileMgr = nullptr;
+    return true;
+  }
+
+  if (State.FileMgr && State.FileMgrCWD == CWD &&
+      State.FileMgr->getFileSystemOpts().WorkingDir ==
+          Clang.getFileSystemOpts().WorkingDir &&
+      State.FileMgr->isCacheUpToDate()) {
+    ++State.NumFileMgrReuses;
+  } else {
+    State.FileMgr = new FileManager(Clang.getFileSystemOpts(),
+                                    vfs::getRealFileSystem());
+    State.FileMgrCWD = CWD;
+  }
+
+  Clang.setVirtualFileSystem(State.FileMgr->getVirtualFileSystem());
+  Clang.setFileManager(State.FileMgr.get());
+  return true;
+}
+
+/// \brief Run a single job, returning its exit status.
+static int runJob(ServerState &State, StringRef CWD,
+                  ArrayRef<const char *> Argv, void *MainAddr) {
+  ++State.NumJobs;
+  if (Argv.size() < 2 || StringRef(Argv[1]) != "-cc1" ||
+      ::chdir(std::string(CWD).c_str()) != 0)
+    return 1;
+
+  int Res = 1;
+  State.FatalErrorStatus = 0;
+  llvm::CrashRecoveryContext CRC;
+  bool Completed = CRC.RunSafely([&]() {
+    Res = cc1_main(Argv.slice(2), Argv[0], MainAddr,
+                   [&](CompilerInstance &Clang) {
+                     llvm::remove_fatal_error_handler();
+                     State.JobDiags = &Clang.getDiagnostics();
+                     llvm::install_fatal_error_handler(ServerFatalErrorHandler,
+                                                       &State);
+                     Clang.getPreprocessorOpts().CachePredefines = true;
+                     return setupSharedFileManager(State, CWD, Clang);
+                   });
+  });
+  State.JobDiags = nullptr;
+
+  // Options set through -mllvm must not leak into the next job.
+  llvm::cl::ResetAllOptionOccurrences();
+
+  // A crash or a fatal error leaves the shared caches in an unknown state.
+  if (!Completed) {
+    llvm::remove_fatal_error_handler();
+    State.FileMgr = nullptr;
+    return State.FatalErrorStatus ? State.FatalErrorStatus : -1;
+  }
+
+  // Stat caches (e.g. from PTH files) belong to the job that installed them.
+  if (State.FileMgr)
+    State.FileMgr->clearStatCaches();
+  return Res;
+}
+
+/// \brief Connect to the server listening on \p SocketPath, returning the
+/// socket or -1.
+static int connectToServer(StringRef SocketPath) {
+  sockaddr_un Addr;
+  if (!fillSocketAddress(SocketPath, Addr))
+    return -1;
+
+  int FD = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (FD < 0)
+    return -1;
+  if (::connect(FD, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr))) {
+    ::close(FD);
+    return -1;
+  }
+  return FD;
+}
+
+int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                   void *MainAddr) {
+  if (Argv.size() == 2 && StringRef(Argv[0]) == "-stop") {
+    int FD = connectToServer(Argv[1]);
+    if (FD < 0 || !writeBlob(FD, StringRef())) {
+      llvm::errs() << "error: unable to reach the server at '" << Argv[1]
+                   << "'\n";
+      return 1;
+    }
+    // Wait for the server to close the connection.
+    char C;
+    while (::read(FD, &C, 1) > 0)
+      ;
+    ::close(FD);
+    return 0;
+  }
+
+  if (Argv.size() != 1) {
+    llvm::errs() << "error: usage: " << Argv0
+                 << " -cc1server [-stop] <socket>\n";
+    return 1;
+  }
+  StringRef SocketPath = Argv[0];
+
+  sockaddr_un Addr;
+  if (!fillSocketAddress(SocketPath, Addr)) {
+    llvm::errs() << "error: socket path too long: '" << SocketPath << "'\n";
+    return 1;
+  }
+
+  int ListenFD = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ::unlink(Addr.sun_path);
+  // Only the owner may connect: whoever can send jobs can run arbitrary code
+  // in the server, e.g. through -load.
+  mode_t OldMask = ::umask(0077);
+  bool Bound =
+      ListenFD >= 0 &&
+      !::bind(ListenFD, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr));
+  ::umask(OldMask);
+  if (!Bound || ::chmod(Addr.sun_path, 0600) || ::listen(ListenFD, 16)) {
+    llvm::errs() << "error: unable to listen on '" << SocketPath
+                 << "': " << strerror(errno) << '\n';
+    return 1;
+  }
+
+  llvm::CrashRecoveryContext::Enable();
+
+  ServerState State;
+  int StopFD = -1;
+  while (true) {
+    int FD = ::accept(ListenFD, nullptr, nullptr);
+    if (FD < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (!isPeerTrusted(FD)) {
+      ::close(FD);
+      continue;
+    }
+
+    std::string Request;
+    if (!readBlob(FD, Request)) {
+      ::close(FD);
+      continue;
+    }
+    if (Request.empty()) {
+      StopFD = FD;
+      break;
+    }
+
+    // Split the request into the working directory and the arguments.
+    std::vector<const char *> Args;
+    for (size_t I = 0, E = Request.size(); I < E;
+         I += strlen(&Request[I]) + 1)
+      Args.push_back(&Request[I]);
+    if (Args.empty()) {
+      ::close(FD);
+      continue;
+    }
+
+    int32_t Status;
+    std::string Out, Err;
+    {
+      CapturedFD CapturedOut(STDOUT_FILENO), CapturedErr(STDERR_FILENO);
+      Status = runJob(State, Args[0], makeArrayRef(Args).slice(1), MainAddr);
+      llvm::outs().flush();
+      llvm::errs().flush();
+      fflush(stdout);
+      fflush(stderr);
+      Out = CapturedOut.release();
+      Err = CapturedErr.release();
+    }
+
+    bool Replied = writeAll(FD, &Status, sizeof(Status)) &&
+                   writeBlob(FD, Out) && writeBlob(FD, Err);
+    (void)Replied;
+    ::close(FD);
+
+    // Don't keep serving from a process which crashed.
+    if (Status < 0)
+      break;
+  }
+
+  ::close(ListenFD);
+  ::unlink(Addr.sun_path);
+
+  llvm::errs() << "cc1server: " << State.NumJobs << " jobs, "
+               << State.NumFileMgrReuses << " file manager reuses\n";
+  // Let 'clang -cc1server -stop' return only once the server is done.
+  if (StopFD >= 0)
+    ::close(StopFD);
+  return 0;
+}
+
+bool sendToCC1Server(StringRef SocketPath, ArrayRef<const char *> Argv,
+                     int &Result) {
+  SmallString<256> CWD;
+  if (llvm::sys::fs::current_path(CWD))
+    return false;
+
+  std::string Request(CWD.str());
+  Request += '\0';
+  for (const char *Arg : Argv) {
+    Request += Arg;
+    Request += '\0';
+  }
+
+  int FD = connectToServer(SocketPath);
+  if (FD < 0)
+    return false;
+
+  int32_t Status;
+  std::string Out, Err;
+  bool Success = writeBlob(FD, Request) &&
+                 readAll(FD, &Status, sizeof(Status)) && readBlob(FD, Out) &&
+                 readBlob(FD, Err);
+  ::close(FD);
+  if (!Success)
+    return false;
+
+  llvm::outs() << Out;
+  llvm::outs().flush();
+  llvm::errs() << Err;
+  Result = Status;
+  return true;
+}
+
+#else
+
+int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                   void *MainAddr) {
+  llvm::errs() << "error: -cc1server is not supported on this host\n";
+  return 1;
+}
+
+bool sendToCC1Server(StringRef SocketPath, ArrayRef<const char *> Argv,
+                     int &Result) {
+  return false;
+}
+
+#endif
@@ -198,6 +198,10 @@ extern int cc1_main(ArrayRef<const char *> Argv, const char *Argv0,
                     void *MainAddr);
 extern int cc1as_main(ArrayRef<const char *> Argv, const char *Argv0,
                       void *MainAddr);
+extern int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                          void *MainAddr);
+extern bool sendToCC1Server(StringRef SocketPath, ArrayRef<const char *> Argv,
+                            int &Result);
 
 static void insertTargetAndModeArgs(StringRef Target, StringRef Mode,
                                     SmallVectorImpl<const char *> &ArgVector,
@@ -299,12 +303,27 @@ static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
     return cc1_main(argv.slice(2), argv[0], GetExecutablePathVP);
   if (Tool == "as")
     return cc1as_main(argv.slice(2), argv[0], GetExecutablePathVP);
+  if (Tool == "server")
+    return cc1server_main(argv.slice(2), argv[0], GetExecutablePathVP);
 
   // Reject unknown tools.
   llvm::errs() << "error: unknown integrated tool '" << Tool << "'\n";
   return 1;
 }
 
+/// The socket of the compile server to send -cc1 jobs to, if any.
+static const char *CC1ServerSocket = nullptr;
+
+/// Entry point for -cc1 jobs which the driver runs in-process.
+static int ExecuteCC1ToolInProcess(ArrayRef<const char *> argv) {
+  return ExecuteCC1Tool(argv, argv[1] + 4);
+}
+
+/// Entry point for -cc1 jobs which the driver sends to a compile server.
+static bool SendCC1ToolToServer(ArrayRef<const char *> argv, int &Res) {
+  return sendToCC1Server(CC1ServerSocket, argv, Res);
+}
+
 int main(int argc_, const char **argv_) {
   llvm::sys::PrintStackTraceOnErrorSignal(argv_[0]);
   llvm::PrettyStackTraceProgram X(argc_, argv_);
@@ -452,6 +471,12 @@ int main(int argc_, const char **argv_) {
                           SavedStrings);
 
   SetBackdoorDriverOutputsFromEnvVars(TheDriver);
+  TheDriver.CC1Main = &ExecuteCC1ToolInProcess;
+  // Handle CLANG_CC1_SERVER, which sends -cc1 jobs to a running
+  // 'clang -cc1server <socket>' process.
+  CC1ServerSocket = ::getenv("CLANG_CC1_SERVER");
+  if (CC1ServerSocket)
+    TheDriver.CC1Server = &SendCC1ToolToServer;
 
   std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
   int Res = 0;
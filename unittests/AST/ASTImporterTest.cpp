@@ -456,5 +456,155 @@ TEST(ImportExpr, ImportInitListExpr) {
 }
 
 
+/// Build the AST of \p Code as file \p FileName, and make the file visible to
+/// the file system of \p ToCtx so that locations in it can be imported.
+static std::unique_ptr<ASTUnit> buildFromAST(const std::string &Code,
+                                             const std::string &FileName,
+                                             ASTContext &ToCtx) {
+  StringVector Args;
+  getLangArgs(Lang_CXX, Args);
+  vfs::OverlayFileSystem *OFS = static_cast<vfs::OverlayFileSystem *>(
+        ToCtx.getSourceManager().getFileManager().getVirtualFileSystem().get());
+  vfs::InMemoryFileSystem *MFS = static_cast<vfs::InMemoryFileSystem *>(
+        OFS->overlays_begin()->get());
+  MFS->addFile(FileName, 0, llvm::MemoryBuffer::getMemBufferCopy(Code));
+  return tooling::buildASTFromCodeWithArgs(Code, Args, FileName);
+}
+
+static NamedDecl *lookupOne(DeclContext *DC, StringRef Name) {
+  DeclContext::lookup_result R =
+      DC->lookup(&cast<Decl>(DC)->getASTContext().Idents.get(Name));
+  return R.size() == 1 ? R.front() : nullptr;
+}
+
+static unsigned countDecls(DeclContext *DC) {
+  return std::distance(DC->decls_begin(), DC->decls_end());
+}
+
+TEST(ImportDecl, RemembersEquivalentDecls) {
+  std::string Code = "struct A { int x; };\n"
+                     "struct B { A a; int y; };\n";
+  std::unique_ptr<ASTUnit> ToAST =
+      tooling::buildASTFromCodeWithArgs(Code, {"-std=c++98"}, "output.cc");
+  ASTContext &ToCtx = ToAST->getASTContext();
+  std::unique_ptr<ASTUnit> FromAST =
+      buildFromAST(Code + "void declToImport(B *b);", "input.cc", ToCtx);
+  ASTContext &FromCtx = FromAST->getASTContext();
+
+  ASTImporter Importer(ToCtx, ToAST->getFileManager(),
+                       FromCtx, FromAST->getFileManager(), false);
+  TranslationUnitDecl *FromTU = FromCtx.getTranslationUnitDecl();
+  TranslationUnitDecl *ToTU = ToCtx.getTranslationUnitDecl();
+  ASSERT_TRUE(Importer.Import(lookupOne(FromTU, "declToImport")));
+
+  // Both records were merged with the existing ones, and proven equivalent
+  // once for all later imports.
+  Decl *FromA = lookupOne(FromTU, "A"), *FromB = lookupOne(FromTU, "B");
+  Decl *ToA = lookupOne(ToTU, "A"), *ToB = lookupOne(ToTU, "B");
+  EXPECT_EQ(ToA, Importer.Import(FromA));
+  EXPECT_EQ(ToB, Importer.Import(FromB));
+  ASTImporter::EquivalentDeclSet &Equivalent = Importer.getEquivalentDecls();
+  EXPECT_TRUE(Equivalent.count(std::make_pair(FromA, ToA)));
+  EXPECT_TRUE(Equivalent.count(std::make_pair(FromB, ToB)));
+  EXPECT_TRUE(Importer.getNonEquivalentDecls().empty());
+}
+
+TEST(ImportDecl, ImportsMembersOnLookup) {
+  std::unique_ptr<ASTUnit> ToAST =
+      tooling::buildASTFromCodeWithArgs("", {"-std=c++98"}, "output.cc");
+  ASTContext &ToCtx = ToAST->getASTContext();
+  std::unique_ptr<ASTUnit> FromAST = buildFromAST(
+      "namespace N {\n"
+      "  int f(int);\n"
+      "  int g(int);\n"
+      "  struct S { int x; int m(); int n(); };\n"
+      "}\n"
+      "int declToImport() { return N::f(0); }\n",
+      "input.cc", ToCtx);
+  ASTContext &FromCtx = FromAST->getASTContext();
+
+  ASTImporter Importer(ToCtx, ToAST->getFileManager(),
+                       FromCtx, FromAST->getFileManager(), false);
+  IntrusiveRefCntPtr<ASTImporterLookupSource> Source(
+      new ASTImporterLookupSource);
+  Source->addImporter(Importer);
+  ToCtx.setExternalSource(Source);
+
+  ASSERT_TRUE(Importer.Import(
+      lookupOne(FromCtx.getTranslationUnitDecl(), "declToImport")));
+  auto *ToN = cast<NamespaceDecl>(
+      lookupOne(ToCtx.getTranslationUnitDecl(), "N"));
+  EXPECT_EQ(1u, countDecls(ToN));
+
+  // Looking up a member imports just that member.
+  EXPECT_TRUE(lookupOne(ToN, "g"));
+  EXPECT_EQ(2u, countDecls(ToN));
+  EXPECT_FALSE(lookupOne(ToN, "h"));
+  EXPECT_EQ(2u, countDecls(ToN));
+
+  // A class comes with its fields; its methods are imported on lookup.
+  auto *ToS = cast_or_null<CXXRecordDecl>(lookupOne(ToN, "S"));
+  ASSERT_TRUE(ToS && ToS->isCompleteDefinition());
+  EXPECT_EQ(1u, countDecls(ToS));
+  EXPECT_TRUE(lookupOne(ToS, "m"));
+  EXPECT_EQ(2u, countDecls(ToS));
+  EXPECT_EQ(3u, Source->getNumLookups());
+  EXPECT_EQ(3u, Source->getNumDeclsImported());
+}
+
+// Merges the ASTs of many translation units which include the same header
+// into one context, the way cross translation unit analysis does, and checks
+// that each of them only pays for what it uses from the header.
+TEST(ImportDecl, MergeManyTranslationUnits) {
+  const unsigned NumTUs = 16, NumFunctions = 64, NumRecords = 16,
+                 NumRecordsUsed = 4;
+  std::string Header = "namespace lib {\n";
+  for (unsigned I = 0; I != NumRecords; ++I)
+    Header += "struct S" + std::to_string(I) + " { int a, b; int get(); "
+              "void set(int); };\n";
+  for (unsigned I = 0; I != NumFunctions; ++I)
+    Header += "int func" + std::to_string(I) + "(int);\n";
+  Header += "}\n";
+
+  std::unique_ptr<ASTUnit> ToAST =
+      tooling::buildASTFromCodeWithArgs("", {"-std=c++98"}, "output.cc");
+  ASTContext &ToCtx = ToAST->getASTContext();
+  IntrusiveRefCntPtr<ASTImporterLookupSource> Source(
+      new ASTImporterLookupSource);
+  ToCtx.setExternalSource(Source);
+
+  std::vector<std::unique_ptr<ASTUnit>> FromASTs;
+  std::vector<std::unique_ptr<ASTImporter>> Importers;
+  for (unsigned I = 0; I != NumTUs; ++I) {
+    std::string N = std::to_string(I);
+    std::string Record = "lib::S" + std::to_string(I % NumRecordsUsed);
+    FromASTs.push_back(buildFromAST(
+        Header + "int user" + N + "(" + Record + " *s) { return lib::func" +
+            N + "(s->a); }\n",
+        "input" + N + ".cc", ToCtx));
+    ASTContext &FromCtx = FromASTs.back()->getASTContext();
+    Importers.emplace_back(new ASTImporter(ToCtx, ToAST->getFileManager(),
+                                           FromCtx,
+                                           FromASTs.back()->getFileManager(),
+                                           false));
+    Source->addImporter(*Importers.back());
+    ASSERT_TRUE(Importers.back()->Import(
+        lookupOne(FromCtx.getTranslationUnitDecl(), "user" + N)));
+  }
+
+  // Every translation unit imported one record and one function, and the
+  // records they share were merged.
+  auto *ToLib = cast<NamespaceDecl>(
+      lookupOne(ToCtx.getTranslationUnitDecl(), "lib"));
+  EXPECT_EQ(NumTUs + NumRecordsUsed, countDecls(ToLib));
+  EXPECT_TRUE(lookupOne(ToLib, "S0"));
+  EXPECT_TRUE(lookupOne(ToLib, "func0"));
+
+  // A lookup of an unused member imports it from every translation unit, and
+  // merges it into one declaration.
+  EXPECT_TRUE(lookupOne(ToLib, "func" + std::to_string(NumFunctions - 1)));
+  EXPECT_EQ(NumTUs + NumRecordsUsed + 1, countDecls(ToLib));
+}
+
 } // end namespace ast_matchers
 } // end namespace clang
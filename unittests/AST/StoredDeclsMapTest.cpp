@@ -0,0 +1,88 @@
+//===- unittests/AST/StoredDeclsMapTest.cpp - Lookup table tests ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/DeclContextInternals.h"
+#include "clang/Basic/IdentifierTable.h"
+#include "clang/Basic/LangOptions.h"
+#include "gtest/gtest.h"
+#include <string>
+
+using namespace clang;
+
+namespace {
+
+class StoredDeclsMapTest : public ::testing::Test {
+protected:
+  StoredDeclsMapTest() : Idents(LangOpts) {}
+
+  DeclarationName name(unsigned I) {
+    return DeclarationName(&Idents.get("name" + std::to_string(I)));
+  }
+
+  /// Insert names 0 to \p N - 1 and check that each of them was new.
+  void insertNames(StoredDeclsMap &Map, unsigned N) {
+    for (unsigned I = 0; I != N; ++I) {
+      auto R = Map.insert(std::make_pair(name(I), StoredDeclsList()));
+      EXPECT_TRUE(R.second);
+      EXPECT_EQ(name(I), R.first->first);
+    }
+  }
+
+  LangOptions LangOpts;
+  IdentifierTable Idents;
+};
+
+TEST_F(StoredDeclsMapTest, SmallTableIsSearchedLinearly) {
+  StoredDeclsMap Map;
+  EXPECT_TRUE(Map.empty());
+  EXPECT_TRUE(Map.find(name(0)) == Map.end());
+
+  insertNames(Map, 3);
+  EXPECT_EQ(3u, Map.size());
+  EXPECT_FALSE(Map.isIndexed());
+  for (unsigned I = 0; I != 3; ++I)
+    EXPECT_EQ(name(I), Map.find(name(I))->first);
+  EXPECT_TRUE(Map.find(name(3)) == Map.end());
+
+  // Inserting a name again finds the existing entry.
+  auto R = Map.insert(std::make_pair(name(1), StoredDeclsList()));
+  EXPECT_FALSE(R.second);
+  EXPECT_TRUE(R.first == Map.begin() + 1);
+  EXPECT_EQ(&Map[name(2)], &Map.find(name(2))->second);
+  EXPECT_EQ(3u, Map.size());
+}
+
+TEST_F(StoredDeclsMapTest, LargeTableIsIndexed) {
+  const unsigned N = 100;
+  StoredDeclsMap Map;
+  insertNames(Map, N);
+  EXPECT_TRUE(Map.isIndexed());
+  EXPECT_EQ(N, Map.size());
+
+  for (unsigned I = 0; I != N; ++I)
+    EXPECT_TRUE(Map.find(name(I)) == Map.begin() + I);
+  EXPECT_TRUE(Map.find(name(N)) == Map.end());
+
+  // operator[] adds missing names to the index too.
+  Map[name(N)];
+  EXPECT_TRUE(Map.find(name(N)) == Map.begin() + N);
+}
+
+TEST_F(StoredDeclsMapTest, IteratesInInsertionOrder) {
+  const unsigned N = 20;
+  StoredDeclsMap Map;
+  insertNames(Map, N);
+
+  unsigned I = 0;
+  for (auto &Entry : Map)
+    EXPECT_EQ(name(I++), Entry.first);
+  EXPECT_EQ(N, I);
+}
+
+} // anonymous namespace
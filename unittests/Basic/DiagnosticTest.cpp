@@ -10,12 +10,38 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/DiagnosticIDs.h"
 #include "gtest/gtest.h"
+#include <string>
+#include <vector>
 
 using namespace llvm;
 using namespace clang;
 
 namespace {
 
+/// Records the levels and messages of the diagnostics it handles, formatting
+/// each message twice like two chained consumers would.
+class RecordingDiagConsumer : public DiagnosticConsumer {
+  bool WantsNotes;
+
+public:
+  std::vector<DiagnosticsEngine::Level> Levels;
+  std::vector<std::string> Messages;
+
+  explicit RecordingDiagConsumer(bool WantsNotes) : WantsNotes(WantsNotes) {}
+
+  bool needsNotes() const override { return WantsNotes; }
+
+  void HandleDiagnostic(DiagnosticsEngine::Level Level,
+                        const Diagnostic &Info) override {
+    SmallString<64> First, Second;
+    Info.FormatDiagnostic(First);
+    Info.FormatDiagnostic(Second);
+    EXPECT_EQ(First.str().str(), Second.str().str());
+    Levels.push_back(Level);
+    Messages.push_back(First.str());
+  }
+};
+
 // Check that DiagnosticErrorTrap works with SuppressAllDiagnostics.
 TEST(DiagnosticTest, suppressAndTrap) {
   DiagnosticsEngine Diags(new DiagnosticIDs(),
@@ -69,4 +95,35 @@ TEST(DiagnosticTest, fatalsAsErrors) {
   EXPECT_TRUE(Diags.hasUnrecoverableErrorOccurred());
 }
 
+// Check that a message formatted for one consumer is reused only for the same
+// diagnostic.
+TEST(DiagnosticTest, formattedMessageIsReusedPerDiagnostic) {
+  auto *Consumer = new RecordingDiagConsumer(/*WantsNotes=*/true);
+  DiagnosticsEngine Diags(new DiagnosticIDs(), new DiagnosticOptions,
+                          Consumer);
+
+  Diags.Report(diag::err_target_unknown_cpu) << "a";
+  Diags.Report(diag::err_target_unknown_cpu) << "b";
+  Diags.Report(diag::note_declared_at);
+
+  ASSERT_EQ(3U, Consumer->Messages.size());
+  EXPECT_EQ("unknown target CPU 'a'", Consumer->Messages[0]);
+  EXPECT_EQ("unknown target CPU 'b'", Consumer->Messages[1]);
+  EXPECT_EQ("declared here", Consumer->Messages[2]);
+}
+
+// Check that notes are dropped when the consumer doesn't need them.
+TEST(DiagnosticTest, notesDroppedWhenNotNeeded) {
+  auto *Consumer = new RecordingDiagConsumer(/*WantsNotes=*/false);
+  DiagnosticsEngine Diags(new DiagnosticIDs(), new DiagnosticOptions,
+                          Consumer);
+
+  Diags.Report(diag::err_target_unknown_cpu) << "a";
+  Diags.Report(diag::note_declared_at);
+
+  ASSERT_EQ(1U, Consumer->Levels.size());
+  EXPECT_EQ(DiagnosticsEngine::Error, Consumer->Levels[0]);
+  EXPECT_TRUE(Diags.hasErrorOccurred());
+}
+
 }
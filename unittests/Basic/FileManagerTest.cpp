@@ -10,8 +10,10 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/VirtualFileSystem.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -248,4 +250,43 @@ TEST_F(FileManagerTest, addRemoveStatCache) {
 
 #endif  // !LLVM_ON_WIN32
 
+TEST(FileManagerCacheTest, isCacheUpToDate) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(new vfs::InMemoryFileSystem);
+  FS->addFile("/dir/a.h", 0, MemoryBuffer::getMemBuffer("int a;"));
+  FileSystemOptions Options;
+  FileManager Manager(Options, FS);
+
+  EXPECT_TRUE(Manager.isCacheUpToDate());
+  ASSERT_NE(nullptr, Manager.getFile("/dir/a.h"));
+  EXPECT_EQ(nullptr, Manager.getFile("/dir/b.h"));
+  EXPECT_EQ(nullptr, Manager.getDirectory("/other"));
+  EXPECT_TRUE(Manager.isCacheUpToDate());
+
+  // A file which didn't exist appears.
+  FS->addFile("/dir/b.h", 0, MemoryBuffer::getMemBuffer("int b;"));
+  EXPECT_FALSE(Manager.isCacheUpToDate());
+}
+
+TEST(FileManagerCacheTest, isCacheUpToDateNoticesNewDirectories) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(new vfs::InMemoryFileSystem);
+  FS->addFile("/dir/a.h", 0, MemoryBuffer::getMemBuffer("int a;"));
+  FileSystemOptions Options;
+  FileManager Manager(Options, FS);
+
+  EXPECT_EQ(nullptr, Manager.getDirectory("/other"));
+  EXPECT_TRUE(Manager.isCacheUpToDate());
+  FS->addFile("/other/c.h", 0, MemoryBuffer::getMemBuffer("int c;"));
+  EXPECT_FALSE(Manager.isCacheUpToDate());
+}
+
+TEST(FileManagerCacheTest, isCacheUpToDateWithVirtualFiles) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(new vfs::InMemoryFileSystem);
+  FileSystemOptions Options;
+  FileManager Manager(Options, FS);
+
+  EXPECT_TRUE(Manager.isCacheUpToDate());
+  Manager.getVirtualFile("/virtual.h", 10, 0);
+  EXPECT_FALSE(Manager.isCacheUpToDate());
+}
+
 } // anonymous namespace
@@ -121,6 +121,46 @@ TEST_F(SourceManagerTest, isBeforeInTranslationUnit) {
   EXPECT_TRUE(SourceMgr.isBeforeInTranslationUnit(idLoc, macroExpEndLoc));
 }
 
+TEST_F(SourceManagerTest, isBeforeInTranslationUnitAcrossIncludes) {
+  auto createFile = [&](SourceLocation IncludeLoc) {
+    return SourceMgr.createFileID(
+        llvm::MemoryBuffer::getMemBuffer("0123456789"), SrcMgr::C_User,
+        /*LoadedID=*/0, /*LoadedOffset=*/0, IncludeLoc);
+  };
+  auto getLoc = [&](FileID FID, unsigned Offset) {
+    return SourceMgr.getLocForStartOfFile(FID).getLocWithOffset(Offset);
+  };
+
+  // main includes A at offset 2 and B at offset 6, A includes C at offset 1
+  // and C includes D at offset 0.
+  FileID Main = createFile(SourceLocation());
+  SourceMgr.setMainFileID(Main);
+  FileID A = createFile(getLoc(Main, 2));
+  FileID C = createFile(getLoc(A, 1));
+  FileID D = createFile(getLoc(C, 0));
+  FileID B = createFile(getLoc(Main, 6));
+
+  SourceLocation Locs[] = {
+    getLoc(Main, 0), getLoc(Main, 2), getLoc(A, 0), getLoc(A, 1),
+    getLoc(C, 0),    getLoc(D, 0),    getLoc(D, 3), getLoc(C, 1),
+    getLoc(A, 2),    getLoc(Main, 3), getLoc(Main, 6), getLoc(B, 0),
+    getLoc(B, 9),    getLoc(Main, 7)
+  };
+  for (unsigned I = 0; I != llvm::array_lengthof(Locs); ++I) {
+    EXPECT_FALSE(SourceMgr.isBeforeInTranslationUnit(Locs[I], Locs[I]));
+    for (unsigned J = I + 1; J != llvm::array_lengthof(Locs); ++J) {
+      EXPECT_TRUE(SourceMgr.isBeforeInTranslationUnit(Locs[I], Locs[J]))
+          << I << " < " << J;
+      EXPECT_FALSE(SourceMgr.isBeforeInTranslationUnit(Locs[J], Locs[I]))
+          << J << " > " << I;
+    }
+  }
+
+  EXPECT_EQ(std::make_pair(C, 0U), SourceMgr.getDecomposedIncludedLoc(D));
+  EXPECT_EQ(std::make_pair(FileID(), 0U),
+            SourceMgr.getDecomposedIncludedLoc(Main));
+}
+
 TEST_F(SourceManagerTest, getColumnNumber) {
   const char *Source =
     "int x;\n"
@@ -171,6 +211,199 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, nullptr));
 }
 
+TEST_F(SourceManagerTest, getLineOffsets) {
+  // Newlines of every kind, with pairs split across 16 byte chunks.
+  const char *Source =
+    "int aa;\r\n"
+    "int b;\n\r"
+    "int c;\r"
+    "int d;\n"
+    "\n"
+    "int e; int ee;\r\n"
+    "int f;\n";
+
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBuffer(Source);
+  FileID MainFileID = SourceMgr.createFileID(std::move(Buf));
+  SourceMgr.setMainFileID(MainFileID);
+
+  ArrayRef<unsigned> Offsets = SourceMgr.getLineOffsets(MainFileID);
+  const unsigned Expected[] = {0, 9, 17, 24, 31, 32, 48, 55};
+  ASSERT_EQ(llvm::array_lengthof(Expected), Offsets.size());
+  for (unsigned I = 0; I != Offsets.size(); ++I)
+    EXPECT_EQ(Expected[I], Offsets[I]);
+
+  EXPECT_EQ(2U, SourceMgr.getLineNumber(MainFileID, 9));
+  EXPECT_EQ(3U, SourceMgr.getLineNumber(MainFileID, 17));
+  EXPECT_EQ(6U, SourceMgr.getLineNumber(MainFileID, 47));
+  EXPECT_EQ(7U, SourceMgr.getLineNumber(MainFileID, 48));
+
+  // Offsets loaded from an AST file don't replace the computed ones.
+  const unsigned Bogus[] = {0, 1};
+  SourceMgr.setPrecomputedLineOffsets(MainFileID, Bogus);
+  EXPECT_EQ(Offsets.size(), SourceMgr.getLineOffsets(MainFileID).size());
+}
+
+TEST_F(SourceManagerTest, setPrecomputedLineOffsets) {
+  auto createFile = [&]() {
+    return SourceMgr.createFileID(
+        llvm::MemoryBuffer::getMemBuffer("int a;\nint b;\nint c;\n"));
+  };
+
+  // A table that fits the file is used as is.
+  FileID Good = createFile();
+  const unsigned GoodOffsets[] = {0, 7, 14, 21};
+  SourceMgr.setPrecomputedLineOffsets(Good, GoodOffsets);
+  EXPECT_EQ(3U, SourceMgr.getLineNumber(Good, 15));
+
+  // Tables that are not increasing or go past the end of the file are
+  // ignored, and the lines are computed from the buffer instead.
+  FileID Unsorted = createFile();
+  const unsigned UnsortedOffsets[] = {0, 14, 7, 21};
+  SourceMgr.setPrecomputedLineOffsets(Unsorted, UnsortedOffsets);
+  EXPECT_EQ(2U, SourceMgr.getLineNumber(Unsorted, 8));
+  EXPECT_EQ(3U, SourceMgr.getLineNumber(Unsorted, 15));
+
+  FileID TooLong = createFile();
+  const unsigned TooLongOffsets[] = {0, 7, 14, 21, 100};
+  SourceMgr.setPrecomputedLineOffsets(TooLong, TooLongOffsets);
+  EXPECT_EQ(4U, SourceMgr.getLineOffsets(TooLong).size());
+}
+
+TEST_F(SourceManagerTest, macroArgTokensShareSLocEntry) {
+  const char *source =
+    "#define M(x) x\n"
+    "M(foo == bar)\n"
+    "M(a                                                            b)";
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBuffer(source);
+  FileID mainFileID = SourceMgr.createFileID(std::move(Buf));
+  SourceMgr.setMainFileID(mainFileID);
+
+  VoidModuleLoader ModLoader;
+  HeaderSearch HeaderInfo(new HeaderSearchOptions, SourceMgr, Diags, LangOpts,
+                          &*Target);
+  Preprocessor PP(new PreprocessorOptions(), Diags, LangOpts, SourceMgr,
+                  HeaderInfo, ModLoader,
+                  /*IILookup =*/nullptr,
+                  /*OwnsHeaderSearch =*/false);
+  PP.Initialize(*Target);
+  PP.EnterMainSourceFile();
+
+  std::vector<Token> toks;
+  while (1) {
+    Token tok;
+    PP.Lex(tok);
+    if (tok.is(tok::eof))
+      break;
+    toks.push_back(tok);
+  }
+  ASSERT_EQ(5U, toks.size());
+
+  // The consecutive tokens of an argument are in the same SLocEntry, and
+  // still have their own spelling locations.
+  for (unsigned i = 0; i != 3; ++i) {
+    ASSERT_TRUE(toks[i].getLocation().isMacroID());
+    EXPECT_TRUE(SourceMgr.isMacroArgExpansion(toks[i].getLocation()));
+    EXPECT_EQ(SourceMgr.getFileID(toks[0].getLocation()),
+              SourceMgr.getFileID(toks[i].getLocation()));
+  }
+  EXPECT_EQ(SourceMgr.translateLineCol(mainFileID, 2, 3),
+            SourceMgr.getSpellingLoc(toks[0].getLocation()));
+  EXPECT_EQ(SourceMgr.translateLineCol(mainFileID, 2, 7),
+            SourceMgr.getSpellingLoc(toks[1].getLocation()));
+  EXPECT_EQ(SourceMgr.translateLineCol(mainFileID, 2, 10),
+            SourceMgr.getSpellingLoc(toks[2].getLocation()));
+  EXPECT_TRUE(SourceMgr.isAtStartOfImmediateMacroExpansion(
+      toks[0].getLocation()));
+  EXPECT_FALSE(SourceMgr.isAtStartOfImmediateMacroExpansion(
+      toks[1].getLocation()));
+
+  // Tokens too far apart get separate entries, to not waste address space.
+  EXPECT_NE(SourceMgr.getFileID(toks[3].getLocation()),
+            SourceMgr.getFileID(toks[4].getLocation()));
+  EXPECT_EQ(SourceMgr.translateLineCol(mainFileID, 3, 64),
+            SourceMgr.getSpellingLoc(toks[4].getLocation()));
+}
+
+// An external source that creates loaded files of "0123456789" on demand,
+// each 11 offsets apart, and counts how many it has created.
+class LazyFileSLocEntrySource : public ExternalSLocEntrySource {
+public:
+  LazyFileSLocEntrySource(SourceManager &SM) : SM(SM), NumLoads(0) {}
+
+  bool ReadSLocEntry(int ID) override {
+    ++NumLoads;
+    SM.createFileID(llvm::MemoryBuffer::getMemBuffer("0123456789"),
+                    SrcMgr::C_User, ID, getOffset(ID));
+    return false;
+  }
+
+  std::pair<SourceLocation, StringRef> getModuleImportLoc(int ID) override {
+    return std::make_pair(SourceLocation(), "");
+  }
+
+  unsigned getOffset(int ID) const { return BaseOffset + (ID - BaseID) * 11; }
+
+  SourceManager &SM;
+  int BaseID;
+  unsigned BaseOffset;
+  unsigned NumLoads;
+};
+
+TEST_F(SourceManagerTest, getFileIDLoadedUsesOffsetIndex) {
+  const unsigned NumEntries = 100;
+  LazyFileSLocEntrySource Source(SourceMgr);
+  SourceMgr.setExternalSLocEntrySource(&Source);
+  std::tie(Source.BaseID, Source.BaseOffset) =
+      SourceMgr.AllocateLoadedSLocEntries(NumEntries, NumEntries * 11);
+  ASSERT_NE(0, Source.BaseID);
+
+  // Provide the offsets up front, as the ASTReader does.
+  for (unsigned I = 0; I != NumEntries; ++I) {
+    int ID = Source.BaseID + I;
+    SourceMgr.setLoadedSLocEntryOffset(ID, Source.getOffset(ID));
+  }
+
+  // Searching the loaded entries only loads the entry that is found.
+  for (unsigned I : {57U, 3U, 99U, 0U}) {
+    int ID = Source.BaseID + I;
+    SourceLocation Loc =
+        SourceLocation::getFromRawEncoding(Source.getOffset(ID) + 3);
+    std::pair<FileID, unsigned> Decomposed = SourceMgr.getDecomposedLoc(Loc);
+    EXPECT_EQ(3U, Decomposed.second);
+    EXPECT_EQ(Source.getOffset(ID),
+              SourceMgr.getLocForStartOfFile(Decomposed.first).getOffset());
+  }
+  EXPECT_EQ(4U, Source.NumLoads);
+}
+
+TEST_F(SourceManagerTest, getFileIDLookaside) {
+  auto createFile = [&]() {
+    return SourceMgr.createFileID(
+        llvm::MemoryBuffer::getMemBuffer("0123456789"));
+  };
+  FileID Files[] = {createFile(), createFile(), createFile(), createFile()};
+  SourceLocation Locs[llvm::array_lengthof(Files)];
+  for (unsigned I = 0; I != llvm::array_lengthof(Files); ++I)
+    Locs[I] = SourceMgr.getLocForStartOfFile(Files[I]).getLocWithOffset(5);
+
+  // Jumping between the first three files only searches for them the first
+  // time; after that, the lookaside finds them.
+  for (unsigned Round = 0; Round != 3; ++Round)
+    for (unsigned I = 0; I != 3; ++I)
+      EXPECT_EQ(Files[I], SourceMgr.getFileID(Locs[I]));
+  EXPECT_EQ(6U, SourceMgr.getNumFileIDLookasideHits());
+
+  // Looking up the same file again hits LastFileIDLookup, not the lookaside.
+  EXPECT_EQ(Files[2], SourceMgr.getFileID(Locs[2]));
+  EXPECT_EQ(6U, SourceMgr.getNumFileIDLookasideHits());
+
+  // The last file created was remembered as well.
+  EXPECT_EQ(Files[3], SourceMgr.getFileID(Locs[3]));
+  EXPECT_EQ(7U, SourceMgr.getNumFileIDLookasideHits());
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
@@ -0,0 +1,224 @@
+//===- unittests/Lex/PPCachingTest.cpp - Token cache tests ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/ModuleLoader.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+class VoidModuleLoader : public ModuleLoader {
+  ModuleLoadResult loadModule(SourceLocation ImportLoc,
+                              ModuleIdPath Path,
+                              Module::NameVisibilityKind Visibility,
+                              bool IsInclusionDirective) override {
+    return ModuleLoadResult();
+  }
+
+  void makeModuleVisible(Module *Mod,
+                         Module::NameVisibilityKind Visibility,
+                         SourceLocation ImportLoc) override { }
+
+  GlobalModuleIndex *loadGlobalModuleIndex(SourceLocation TriggerLoc) override
+    { return nullptr; }
+  bool lookupMissingImports(StringRef Name, SourceLocation TriggerLoc) override
+    { return 0; }
+};
+
+// The test fixture.
+class PPCachingTest : public ::testing::Test {
+protected:
+  PPCachingTest()
+    : FileMgr(FileMgrOpts),
+      DiagID(new DiagnosticIDs()),
+      Diags(DiagID, new DiagnosticOptions, new IgnoringDiagConsumer()),
+      SourceMgr(Diags, FileMgr),
+      TargetOpts(new TargetOptions)
+  {
+    TargetOpts->Triple = "x86_64-apple-darwin11.1.0";
+    Target = TargetInfo::CreateTargetInfo(Diags, TargetOpts);
+  }
+
+  void startLexing(StringRef Source) {
+    std::unique_ptr<llvm::MemoryBuffer> Buf =
+        llvm::MemoryBuffer::getMemBuffer(Source);
+    SourceMgr.setMainFileID(SourceMgr.createFileID(std::move(Buf)));
+
+    HeaderInfo.reset(new HeaderSearch(new HeaderSearchOptions, SourceMgr,
+                                      Diags, LangOpts, Target.get()));
+    PP.reset(new Preprocessor(new PreprocessorOptions(), Diags, LangOpts,
+                              SourceMgr, *HeaderInfo, ModLoader,
+                              /*IILookup =*/nullptr,
+                              /*OwnsHeaderSearch =*/false));
+    PP->Initialize(*Target);
+    PP->EnterMainSourceFile();
+  }
+
+  /// Lex the next token and return its spelling.
+  std::string next() {
+    Token Tok;
+    PP->Lex(Tok);
+    if (Tok.is(tok::eof))
+      return "<eof>";
+    if (Tok.is(tok::annot_primary_expr))
+      return "<annot>";
+    return PP->getSpelling(Tok);
+  }
+
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+  LangOptions LangOpts;
+  std::shared_ptr<TargetOptions> TargetOpts;
+  IntrusiveRefCntPtr<TargetInfo> Target;
+  VoidModuleLoader ModLoader;
+  std::unique_ptr<HeaderSearch> HeaderInfo;
+  std::unique_ptr<Preprocessor> PP;
+};
+
+TEST_F(PPCachingTest, NestedBacktrack) {
+  startLexing("a b c d e");
+
+  PP->EnableBacktrackAtThisPos();
+  EXPECT_EQ("a", next());
+  PP->EnableBacktrackAtThisPos();
+  EXPECT_EQ("b", next());
+  EXPECT_EQ("c", next());
+  PP->Backtrack();
+  EXPECT_EQ(2u, PP->getNumCachedTokensAhead());
+  EXPECT_EQ("b", next());
+  PP->Backtrack();
+  EXPECT_EQ(3u, PP->getNumCachedTokensAhead());
+
+  EXPECT_EQ("a", next());
+  EXPECT_EQ("b", next());
+  EXPECT_EQ("c", next());
+  EXPECT_EQ("d", next());
+  EXPECT_EQ("e", next());
+  EXPECT_EQ("<eof>", next());
+}
+
+TEST_F(PPCachingTest, CommitReleasesTokens) {
+  startLexing("a b c d");
+
+  PP->EnableBacktrackAtThisPos();
+  EXPECT_EQ("a", next());
+  EXPECT_EQ("b", next());
+  PP->CommitBacktrackedTokens();
+  EXPECT_EQ(0u, PP->getNumCachedTokensAhead());
+
+  // Tokens looked ahead at stay cached across a committed backtrack.
+  EXPECT_EQ("d", PP->getSpelling(PP->LookAhead(1)));
+  PP->EnableBacktrackAtThisPos();
+  EXPECT_EQ("c", next());
+  PP->CommitBacktrackedTokens();
+  EXPECT_EQ(1u, PP->getNumCachedTokensAhead());
+
+  unsigned Generation = PP->getTokenCacheGeneration();
+  EXPECT_EQ("d", next());
+  EXPECT_EQ("<eof>", next());
+  EXPECT_NE(Generation, PP->getTokenCacheGeneration());
+}
+
+TEST_F(PPCachingTest, AnnotationSurvivesBacktrack) {
+  startLexing("a b c d");
+
+  PP->EnableBacktrackAtThisPos();
+  EXPECT_EQ("a", next());
+
+  Token B, C;
+  PP->Lex(B);
+  PP->Lex(C);
+  Token Annot;
+  Annot.startToken();
+  Annot.setKind(tok::annot_primary_expr);
+  Annot.setLocation(B.getLocation());
+  Annot.setAnnotationEndLoc(C.getLocation());
+  PP->AnnotateCachedTokens(Annot);
+
+  EXPECT_EQ("d", next());
+  PP->RevertCachedTokens(1);
+  EXPECT_EQ(1u, PP->getNumCachedTokensAhead());
+  PP->Backtrack();
+
+  EXPECT_EQ("a", next());
+  EXPECT_EQ("<annot>", next());
+  EXPECT_EQ("d", next());
+  EXPECT_EQ("<eof>", next());
+}
+
+TEST_F(PPCachingTest, EnterTokenWhileBacktracking) {
+  startLexing("a b");
+
+  PP->EnableBacktrackAtThisPos();
+  EXPECT_EQ("a", next());
+  Token B;
+  PP->Lex(B);
+  PP->EnterToken(B);
+  EXPECT_EQ("b", next());
+  PP->Backtrack();
+
+  // The entered token stays where it was entered.
+  EXPECT_EQ("a", next());
+  EXPECT_EQ("b", next());
+  EXPECT_EQ("b", next());
+  EXPECT_EQ("<eof>", next());
+}
+
+// Nested backtracking and committing while a long run of tokens is cached,
+// the way deeply nested tentative parses use the cache.
+TEST_F(PPCachingTest, DeepBacktrackingOverManyTokens) {
+  const unsigned NumTokens = 20000, Depth = 64;
+  std::string Source;
+  for (unsigned I = 0; I != NumTokens; ++I)
+    Source += "t" + std::to_string(I) + " ";
+  startLexing(Source);
+
+  // Look at everything once, then keep backtracking from deeper and deeper
+  // positions, committing every other level.
+  PP->EnableBacktrackAtThisPos();
+  for (unsigned I = 0; I != NumTokens; ++I)
+    next();
+  PP->Backtrack();
+  EXPECT_EQ(NumTokens, PP->getNumCachedTokensAhead());
+
+  unsigned Consumed = 0;
+  for (unsigned Level = 0; Level != Depth; ++Level) {
+    PP->EnableBacktrackAtThisPos();
+    for (unsigned I = 0; I != NumTokens / (2 * Depth); ++I)
+      EXPECT_EQ("t" + std::to_string(Consumed + I), next());
+    if (Level % 2)
+      PP->Backtrack();
+    else
+      Consumed += NumTokens / (2 * Depth);
+  }
+  for (unsigned Level = 0; Level != Depth / 2; ++Level)
+    PP->CommitBacktrackedTokens();
+
+  for (unsigned I = Consumed; I != NumTokens; ++I)
+    ASSERT_EQ("t" + std::to_string(I), next());
+  EXPECT_EQ("<eof>", next());
+  EXPECT_EQ(0u, PP->getNumCachedTokensAhead());
+}
+
+} // anonymous namespace
@@ -48,4 +48,114 @@ TEST(RewriteBuffer, TagRanges) {
   EXPECT_EQ(Output, Result);
 }
 
+static std::string getText(const RewriteBuffer &Buf) {
+  std::string Result;
+  raw_string_ostream OS(Result);
+  Buf.write(OS);
+  return OS.str();
+}
+
+static void applyOneByOne(ArrayRef<RewriteBuffer::Edit> Edits,
+                          RewriteBuffer &Buf) {
+  for (const RewriteBuffer::Edit &E : Edits) {
+    if (E.OrigLength)
+      Buf.ReplaceText(E.OrigOffset, E.OrigLength, E.Text);
+    else
+      Buf.InsertText(E.OrigOffset, E.Text, E.InsertAfter);
+  }
+}
+
+TEST(RewriteBuffer, BatchedEditsMatchEditsOneByOne) {
+  StringRef Input = "int foo(int x) { return x; }";
+  typedef RewriteBuffer::Edit Edit;
+  std::vector<Edit> Edits = {
+    Edit(24, 1, "y"),
+    Edit(0, 0, "static "),
+    Edit(4, 0, "<a>"),
+    Edit(4, 3, "bar"),
+    Edit(4, 0, "<b>", /*InsertAfter=*/false),
+    Edit(4, 0, "<c>"),
+    Edit(4, 0, "<d>", /*InsertAfter=*/false),
+    Edit(12, 1, "y"),
+    Edit(16, 8, ""),
+    Edit(28, 0, "\n"),
+  };
+
+  RewriteBuffer OneByOne, Batched;
+  OneByOne.Initialize(Input);
+  Batched.Initialize(Input);
+  // Start out with text already inserted at some of the edited positions.
+  for (RewriteBuffer *Buf : {&OneByOne, &Batched}) {
+    Buf->InsertTextAfter(4, "[");
+    Buf->InsertTextBefore(15, "]");
+  }
+
+  applyOneByOne(Edits, OneByOne);
+  Batched.applyEdits(Edits);
+  EXPECT_EQ("static int <d><b>[<a><c>bar(int y) ]{y; }\n", getText(OneByOne));
+  EXPECT_EQ(getText(OneByOne), getText(Batched));
+
+  // Later edits are mapped through the batch.
+  for (RewriteBuffer *Buf : {&OneByOne, &Batched}) {
+    Buf->InsertTextAfter(7, "_1");
+    Buf->InsertTextBefore(14, " ");
+    Buf->RemoveText(27, 1);
+  }
+  EXPECT_EQ(getText(OneByOne), getText(Batched));
+}
+
+TEST(RewriteBuffer, OverlappingBatchedEditsAreRejected) {
+  StringRef Input = "int foo(int x) { return x; }";
+  typedef RewriteBuffer::Edit Edit;
+  std::vector<Edit> Overlapping[] = {
+    {Edit(4, 3, "bar"), Edit(6, 2, "z(")},
+    {Edit(4, 3, "bar"), Edit(4, 1, "b")},
+    {Edit(4, 3, "bar"), Edit(5, 0, "_")},
+  };
+
+  for (const std::vector<Edit> &Edits : Overlapping) {
+    // Both with a small buffer, which is rebuilt, and with a large one, which
+    // is edited one edit at a time.
+    for (unsigned Padding : {0, 100000}) {
+      std::string Text = Input.str() + std::string(Padding, ' ');
+      RewriteBuffer Buf;
+      Buf.Initialize(Text);
+      EXPECT_TRUE(Buf.applyEdits(Edits));
+      EXPECT_EQ(Text, getText(Buf));
+    }
+  }
+
+  // Insertions at either end of a replaced range are not overlaps.
+  RewriteBuffer Buf;
+  Buf.Initialize(Input);
+  std::vector<Edit> Edits = {Edit(4, 3, "bar"), Edit(4, 0, "<"),
+                             Edit(7, 0, ">")};
+  EXPECT_FALSE(Buf.applyEdits(Edits));
+  EXPECT_EQ("int <bar>(int x) { return x; }", getText(Buf));
+}
+
+// Rewrites every line of a large file, the way a migration touches every
+// declaration in it.
+TEST(RewriteBuffer, ManyBatchedEdits) {
+  const unsigned NumLines = 100000;
+  std::string Input, Expected;
+  for (unsigned I = 0; I != NumLines; ++I) {
+    Input += "  int x" + std::to_string(I) + " = 0;\n";
+    Expected += "  long x" + std::to_string(I) + " = 0; // migrated\n";
+  }
+
+  std::vector<RewriteBuffer::Edit> Edits;
+  for (size_t Line = 0; Line < Input.size();) {
+    size_t LineEnd = Input.find('\n', Line);
+    Edits.push_back(RewriteBuffer::Edit(Line + 2, 3, "long"));
+    Edits.push_back(RewriteBuffer::Edit(LineEnd, 0, " // migrated"));
+    Line = LineEnd + 1;
+  }
+
+  RewriteBuffer Buf;
+  Buf.Initialize(Input);
+  Buf.applyEdits(Edits);
+  EXPECT_EQ(Expected, getText(Buf));
+}
+
 } // anonymous namespace